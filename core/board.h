@@ -0,0 +1,220 @@
+#pragma once
+// Геометрия парковки W x H с выездами шириной ExitWidth, вычисляемая при компиляции:
+// маска выездов и таблица клеток строятся constexpr, циклы по словам маски разворачиваются
+
+#include <stdint.h>
+#include <array>
+#include <type_traits>
+#include <vector>
+
+// Точка на сетке парковки
+struct Point {
+    int x, y;
+};
+
+// Битовая маска клеток из N 64-битных слов
+template <int N>
+struct BitMask {
+    uint64_t w[N] = {};
+
+    constexpr BitMask operator|(const BitMask& o) const {
+        BitMask r;
+        for (int i = 0; i < N; i++) r.w[i] = w[i] | o.w[i];
+        return r;
+    }
+    constexpr BitMask operator&(const BitMask& o) const {
+        BitMask r;
+        for (int i = 0; i < N; i++) r.w[i] = w[i] & o.w[i];
+        return r;
+    }
+    constexpr BitMask operator~() const {
+        BitMask r;
+        for (int i = 0; i < N; i++) r.w[i] = ~w[i];
+        return r;
+    }
+    constexpr bool operator==(const BitMask& o) const {
+        for (int i = 0; i < N; i++)
+            if (w[i] != o.w[i]) return false;
+        return true;
+    }
+    constexpr bool operator!=(const BitMask& o) const { return !(*this == o); }
+};
+
+// Операции над масками: парковка до 64 клеток хранится в одном uint64_t
+inline constexpr bool maskAny(uint64_t m) { return m != 0; }
+inline constexpr void maskSet(uint64_t& m, int cell) { m |= 1ULL << cell; }
+inline constexpr void maskClear(uint64_t& m, int cell) { m &= ~(1ULL << cell); }
+inline constexpr bool maskTest(uint64_t m, int cell) { return (m >> cell) & 1; }
+
+template <int N> constexpr bool maskAny(const BitMask<N>& m) {
+    uint64_t any = 0;
+    for (int i = 0; i < N; i++) any |= m.w[i];
+    return any != 0;
+}
+template <int N> constexpr void maskSet(BitMask<N>& m, int cell) { m.w[cell >> 6] |= 1ULL << (cell & 63); }
+template <int N> constexpr void maskClear(BitMask<N>& m, int cell) { m.w[cell >> 6] &= ~(1ULL << (cell & 63)); }
+template <int N> constexpr bool maskTest(const BitMask<N>& m, int cell) { return (m.w[cell >> 6] >> (cell & 63)) & 1; }
+
+// Маска парковки, размер которой известен только во время работы
+struct DynamicMask {
+    std::vector<uint64_t> w;
+};
+
+inline void maskSet(DynamicMask& m, int cell) { m.w[cell >> 6] |= 1ULL << (cell & 63); }
+inline void maskClear(DynamicMask& m, int cell) { m.w[cell >> 6] &= ~(1ULL << (cell & 63)); }
+inline bool maskTest(const DynamicMask& m, int cell) { return (m.w[cell >> 6] >> (cell & 63)) & 1; }
+
+// Очистка маски без изменения ее размера
+inline void maskClearAll(uint64_t& m) { m = 0; }
+template <int N> void maskClearAll(BitMask<N>& m) { m = BitMask<N>(); }
+inline void maskClearAll(DynamicMask& m) { for (uint64_t& word : m.w) word = 0; }
+
+// Клетки, занимаемые машиной
+template <class Mask>
+struct BoardFootprint {
+    Mask mask;           // Клетки внутри парковки
+    bool offGrid;        // Есть клетки за пределами парковки
+    bool offGridBlocked; // Есть клетки за пределами парковки и вне выездов
+};
+
+// Клетка из таблицы: номер бита внутри парковки (-1 снаружи) и признак выезда
+struct BoardCell {
+    int16_t index;
+    bool exit;
+};
+
+const int BOARD_MARGIN = 4;   // Рамка вокруг парковки, покрытая таблицей клеток
+const int MAX_LOT_SIZE = 64;  // Наибольшая сторона парковки
+
+// Единственное место, где задана форма выезда: полоса шириной exitWidth вокруг центра каждой стороны
+constexpr bool boardExitFormula(int w, int h, int exitWidth, int x, int y) {
+    const Point centers[4] = {{0, h / 2}, {w, h / 2}, {w / 2, 0}, {w / 2, h}};
+    for (int i = 0; i < 4; i++) {
+        int dx = x - centers[i].x, dy = y - centers[i].y;
+        if ((dx == 0 && dy >= -exitWidth / 2 && dy <= exitWidth / 2) ||
+            (dy == 0 && dx >= -exitWidth / 2 && dx <= exitWidth / 2))
+            return true;
+    }
+    return false;
+}
+
+// Таблица клеток парковки вместе с рамкой BOARD_MARGIN
+template <int W, int H, int ExitWidth>
+constexpr std::array<BoardCell, (W + 2 * BOARD_MARGIN) * (H + 2 * BOARD_MARGIN)> buildBoardCells() {
+    const int frameW = W + 2 * BOARD_MARGIN;
+    std::array<BoardCell, (W + 2 * BOARD_MARGIN) * (H + 2 * BOARD_MARGIN)> t = {};
+    for (int y = -BOARD_MARGIN; y < H + BOARD_MARGIN; y++)
+        for (int x = -BOARD_MARGIN; x < W + BOARD_MARGIN; x++) {
+            bool inside = x >= 0 && x < W && y >= 0 && y < H;
+            BoardCell& c = t[(y + BOARD_MARGIN) * frameW + (x + BOARD_MARGIN)];
+            c.index = (int16_t)(inside ? y * W + x : -1);
+            c.exit = boardExitFormula(W, H, ExitWidth, x, y);
+        }
+    return t;
+}
+
+// Маска клеток выездов внутри парковки
+template <int W, int H, int ExitWidth, class Mask>
+constexpr Mask buildBoardExitMask() {
+    Mask m = {};
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++)
+            if (boardExitFormula(W, H, ExitWidth, x, y)) maskSet(m, y * W + x);
+    return m;
+}
+
+template <int W, int H, int ExitWidth>
+struct Board {
+    static constexpr int WIDTH = W;
+    static constexpr int HEIGHT = H;
+    static constexpr int EXIT_WIDTH = ExitWidth;
+    static constexpr int CELLS = W * H;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+    static constexpr int FRAME_W = W + 2 * BOARD_MARGIN;
+    static constexpr int FRAME_H = H + 2 * BOARD_MARGIN;
+
+    static_assert(ExitWidth / 2 < BOARD_MARGIN, "Выезды не помещаются в рамку таблицы клеток");
+    static_assert(CELLS <= 32767, "Номер клетки не помещается в int16_t");
+
+    typedef typename std::conditional<WORDS == 1, uint64_t, BitMask<WORDS>>::type Mask;
+    typedef std::array<unsigned char, CELLS> Counts;  // Число машин в каждой клетке
+    static constexpr bool DYNAMIC = false;
+
+    // Позиции выездов с парковки (центры сторон)
+    static constexpr Point exits[4] = {
+        {0, H / 2},  // Левый край
+        {W, H / 2},  // Правый край
+        {W / 2, 0},  // Верхний край
+        {W / 2, H}   // Нижний край
+    };
+
+    static constexpr std::array<BoardCell, FRAME_W * FRAME_H> cells = buildBoardCells<W, H, ExitWidth>();
+    static constexpr Mask exitMask = buildBoardExitMask<W, H, ExitWidth, Mask>();
+
+    static constexpr int width() { return W; }
+    static constexpr int height() { return H; }
+    static constexpr int exitWidth() { return ExitWidth; }
+    static constexpr int cellCount() { return CELLS; }
+
+    static constexpr bool inGrid(int x, int y) {
+        return x >= 0 && x < W && y >= 0 && y < H;
+    }
+
+    // Клетка по координатам; за пределами рамки - заблокированная клетка вне парковки
+    static constexpr BoardCell cell(int x, int y) {
+        if (x < -BOARD_MARGIN || x >= W + BOARD_MARGIN || y < -BOARD_MARGIN || y >= H + BOARD_MARGIN)
+            return BoardCell{-1, false};
+        return cells[(y + BOARD_MARGIN) * FRAME_W + (x + BOARD_MARGIN)];
+    }
+
+    static constexpr bool isExitCell(int x, int y) { return cell(x, y).exit; }
+};
+
+// Парковка, размер которой задается во время работы (до MAX_LOT_SIZE x MAX_LOT_SIZE).
+// Интерфейс совпадает с Board, таблица клеток строится в конструкторе.
+class DynamicBoard {
+public:
+    typedef DynamicMask Mask;
+    typedef std::vector<unsigned char> Counts;
+    static constexpr bool DYNAMIC = true;
+
+    DynamicBoard(int w, int h, int exitWidth) : w_(w), h_(h), exitWidth_(exitWidth),
+        frameW_(w + 2 * BOARD_MARGIN), cells_((w + 2 * BOARD_MARGIN) * (h + 2 * BOARD_MARGIN)) {
+        for (int y = -BOARD_MARGIN; y < h + BOARD_MARGIN; y++)
+            for (int x = -BOARD_MARGIN; x < w + BOARD_MARGIN; x++) {
+                BoardCell& c = cells_[(y + BOARD_MARGIN) * frameW_ + (x + BOARD_MARGIN)];
+                c.index = (int16_t)(inGrid(x, y) ? y * w + x : -1);
+                c.exit = boardExitFormula(w, h, exitWidth, x, y);
+            }
+    }
+
+    int width() const { return w_; }
+    int height() const { return h_; }
+    int exitWidth() const { return exitWidth_; }
+    int cellCount() const { return w_ * h_; }
+
+    bool inGrid(int x, int y) const {
+        return x >= 0 && x < w_ && y >= 0 && y < h_;
+    }
+
+    BoardCell cell(int x, int y) const {
+        if (x < -BOARD_MARGIN || x >= w_ + BOARD_MARGIN || y < -BOARD_MARGIN || y >= h_ + BOARD_MARGIN)
+            return BoardCell{-1, false};
+        return cells_[(y + BOARD_MARGIN) * frameW_ + (x + BOARD_MARGIN)];
+    }
+
+    bool isExitCell(int x, int y) const { return cell(x, y).exit; }
+
+    // Пустые маска и счетчики под размер парковки
+    Mask makeMask() const { return Mask{std::vector<uint64_t>((cellCount() + 63) / 64)}; }
+    Counts makeCounts() const { return Counts(cellCount()); }
+
+private:
+    int w_, h_, exitWidth_, frameW_;
+    std::vector<BoardCell> cells_;
+};
+
+// Размеры, для которых правила собраны заранее (выбираются во время работы через createLot)
+typedef Board<8, 8, 2> Board8;
+typedef Board<10, 10, 2> Board10;
+typedef Board<16, 16, 2> Board16;
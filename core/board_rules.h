@@ -0,0 +1,527 @@
+#pragma once
+// Правила игры для парковки любого размера: Board<W, H, ExitWidth> (размер известен при компиляции)
+// или DynamicBoard (размер задается во время работы).
+// Состояние S - Parking или LotState: поля cars, carCount, obstacles, obstacleCount, moves,
+// obstacleMask, carMask (тип B::Mask) и carCellCount (B::Counts).
+// Ход проверяет и меняет только клетки самой машины, поэтому его стоимость
+// не зависит ни от размера парковки, ни от числа машин.
+
+#include "parking.h"
+
+namespace rules {
+
+// Функция расчета клеток машины после сдвига на (dx, dy)
+template <class B>
+inline BoardFootprint<typename B::Mask> footprint(const B& board, const Car& car, int dx, int dy) {
+    BoardFootprint<typename B::Mask> fp = {};
+    for (int i = 0; i < car.length; i++) {
+        int cx, cy;
+        carCell(car, i, &cx, &cy);
+        BoardCell c = board.cell(cx + dx, cy + dy);
+        if (c.index >= 0) {
+            maskSet(fp.mask, c.index);
+        } else {
+            fp.offGrid = true;
+            if (!c.exit) fp.offGridBlocked = true;
+        }
+    }
+    return fp;
+}
+
+// Индекс клеток машин есть только у парковки 8x8 (Parking, перегрузки в parking.h)
+template <class S> inline void indexCarCell(S&, const Car&, int, bool) {}
+template <class S> inline void clearCarIndex(S&) {}
+
+// Функция добавления машины в карту занятости (car - элемент p.cars)
+template <class B, class S>
+inline void addCar(const B& board, S& p, const Car& car) {
+    for (int i = 0; i < car.length; i++) {
+        int cx, cy;
+        carCell(car, i, &cx, &cy);
+        int index = board.cell(cx, cy).index;
+        if (index < 0) continue;
+        if (p.carCellCount[index]++ == 0) maskSet(p.carMask, index);
+        indexCarCell(p, car, index, true);
+    }
+}
+
+// Функция удаления машины из карты занятости
+template <class B, class S>
+inline void removeCar(const B& board, S& p, const Car& car) {
+    for (int i = 0; i < car.length; i++) {
+        int cx, cy;
+        carCell(car, i, &cx, &cy);
+        int index = board.cell(cx, cy).index;
+        if (index < 0) continue;
+        if (--p.carCellCount[index] == 0) maskClear(p.carMask, index);
+        indexCarCell(p, car, index, false);
+    }
+}
+
+// Функция сброса карты занятости машин
+template <class S>
+inline void clearCars(S& p) {
+    maskClearAll(p.carMask);
+    for (auto& count : p.carCellCount) count = 0;
+    clearCarIndex(p);
+}
+
+// Функция проверки, свободна ли клетка (выезды свободны всегда)
+template <class B, class S>
+inline bool cellFree(const B& board, const S& p, int x, int y) {
+    BoardCell c = board.cell(x, y);
+    if (c.exit) return true;
+    if (c.index < 0) return false;
+    return !maskTest(p.obstacleMask, c.index) && !maskTest(p.carMask, c.index);
+}
+
+// Функция проверки, стоит ли машина целиком на выезде
+// (клетки вне парковки после canMove - только выезды)
+template <class B>
+inline bool onExit(const B& board, const Car& car) {
+    for (int i = 0; i < car.length; i++) {
+        int cx, cy;
+        carCell(car, i, &cx, &cy);
+        BoardCell c = board.cell(cx, cy);
+        if (c.index >= 0 && !c.exit) return false;
+    }
+    return true;
+}
+
+// Функция проверки, занимает ли машина клетку
+inline bool carCovers(const Car& car, int x, int y) {
+    for (int i = 0; i < car.length; i++) {
+        int cx, cy;
+        carCell(car, i, &cx, &cy);
+        if (cx == x && cy == y) return true;
+    }
+    return false;
+}
+
+// Функция проверки хода: собственные клетки машины не мешают (даже если после поворота
+// она наехала на препятствие или другую машину), выезды всегда свободны
+template <class B, class S>
+inline bool canMove(const B& board, const S& p, const Car& car, int dx, int dy) {
+    if (car.exited) return false;
+    for (int i = 0; i < car.length; i++) {
+        int cx, cy;
+        carCell(car, i, &cx, &cy);
+        cx += dx;
+        cy += dy;
+        BoardCell c = board.cell(cx, cy);
+        if (c.exit) continue;
+        if (c.index < 0) return false;
+        if (!maskTest(p.obstacleMask, c.index) && !maskTest(p.carMask, c.index)) continue;
+        if (!carCovers(car, cx, cy)) return false;
+    }
+    return true;
+}
+
+// Функция перемещения машины (возвращает false, если ход невозможен)
+template <class B, class S>
+inline bool moveCar(const B& board, S& p, Car& car, int dx, int dy) {
+    if (!canMove(board, p, car, dx, dy)) return false;
+
+    removeCar(board, p, car);
+    car.x += dx;
+    car.y += dy;
+    p.moves++;
+    car.exited = onExit(board, car);
+    if (!car.exited) addCar(board, p, car);
+    return true;
+}
+
+// Функция поворота машины на месте (без проверки столкновений, как в исходной игре)
+template <class B, class S>
+inline void rotateCar(const B& board, S& p, Car& car, bool turnLeft) {
+    if (car.exited) return;
+    removeCar(board, p, car);
+    car.dir = turnDirection(car.dir, turnLeft);
+    addCar(board, p, car);
+}
+
+// Функция выполнения действия игрока (возвращает true, если состояние изменилось)
+template <class B, class S>
+inline bool applyAction(const B& board, S& p, Car& car, CarAction action) {
+    if (car.exited) return false;
+
+    int dx = 0, dy = 0;
+    directionDelta(car.dir, &dx, &dy);
+    switch (action) {
+        case MOVE_FORWARD:  return moveCar(board, p, car, dx, dy);
+        case MOVE_BACKWARD: return moveCar(board, p, car, -dx, -dy);
+        case TURN_LEFT:     rotateCar(board, p, car, true);  return true;
+        case TURN_RIGHT:    rotateCar(board, p, car, false); return true;
+    }
+    return false;
+}
+
+// Функция отмены действия, выполненного applyAction: прежнее положение машины восстанавливается
+// по ее направлению и виду действия, без снимка состояния
+template <class B, class S>
+inline void undoAction(const B& board, S& p, Car& car, CarAction action) {
+    if (action == TURN_LEFT || action == TURN_RIGHT) {
+        removeCar(board, p, car);
+        car.dir = turnDirection(car.dir, action == TURN_RIGHT); // Поворот в обратную сторону
+        addCar(board, p, car);
+        return;
+    }
+
+    int dx = 0, dy = 0;
+    directionDelta(car.dir, &dx, &dy);
+    if (action == MOVE_BACKWARD) {
+        dx = -dx;
+        dy = -dy;
+    }
+    if (car.exited) car.exited = false; // Выехавшей машины нет в карте занятости
+    else removeCar(board, p, car);
+    car.x -= dx;
+    car.y -= dy;
+    p.moves--;
+    addCar(board, p, car);
+}
+
+// Функция проверки условия победы (все машины выехали)
+template <class S>
+inline bool allExited(const S& p) {
+    for (int i = 0; i < p.carCount; i++)
+        if (!p.cars[i].exited) return false;
+    return true;
+}
+
+// Число препятствий и машин для сложности: на парковке 8x8 как в исходной игре, на больших - по площади
+template <class B>
+inline int obstacleCountFor(const B& board, int difficulty) {
+    return (MINOBSTACLECOUNT + (difficulty - 1) * 2) * board.cellCount() / 64;
+}
+
+template <class B>
+inline int carCountFor(const B& board, int difficulty) {
+    return (10 + (difficulty - 1) * 5) * board.cellCount() / 64;
+}
+
+// Форма фигуры для расстановки: клетки идут от якоря с шагом (dx, dy),
+// якорь выбирается из прямоугольника minX..maxX x minY..maxY (как в исходной игре)
+struct PieceShape {
+    int dx, dy;
+    int length;
+    int minX, maxX, minY, maxY;
+};
+
+// Индекс допустимых мест для фигуры одной формы: список якорей, куда она сейчас помещается.
+// Строится, когда случайные пробы перестают попадать, затем места только убираются
+// по мере расстановки фигур, поэтому выбор места - одно случайное число.
+class PlacementIndex {
+public:
+    // Функция построения индекса; fits(x, y) - помещается ли фигура с якорем (x, y)
+    template <class Fits>
+    void build(const PieceShape& shape, int width, int cells, Fits fits) {
+        shape_ = shape;
+        width_ = width;
+        anchors_.clear();
+        slot_.assign(cells, -1);
+        for (int y = shape.minY; y <= shape.maxY; y++)
+            for (int x = shape.minX; x <= shape.maxX; x++)
+                if (fits(x, y)) {
+                    slot_[y * width + x] = (int)anchors_.size();
+                    anchors_.push_back(y * width + x);
+                }
+        built_ = true;
+    }
+
+    bool built() const { return built_; }
+    void reset() { built_ = false; }
+    const PieceShape& shape() const { return shape_; }
+    int size() const { return (int)anchors_.size(); }
+
+    // Случайное допустимое место (индекс не должен быть пуст)
+    void sample(ParkingRng& rng, int* x, int* y) const {
+        int anchor = anchors_[randomInt(rng, size())];
+        *x = anchor % width_;
+        *y = anchor / width_;
+    }
+
+    // Функция удаления всех мест, где фигура накрыла бы клетку (x, y)
+    void removeCovering(int x, int y) {
+        for (int j = 0; j < shape_.length; j++) {
+            int ax = x - j * shape_.dx, ay = y - j * shape_.dy;
+            if (ax < shape_.minX || ax > shape_.maxX || ay < shape_.minY || ay > shape_.maxY) continue;
+            int anchor = ay * width_ + ax;
+            int pos = slot_[anchor];
+            if (pos < 0) continue;
+            int last = anchors_.back();
+            anchors_[pos] = last;
+            slot_[last] = pos;
+            anchors_.pop_back();
+            slot_[anchor] = -1;
+        }
+    }
+
+private:
+    PieceShape shape_ = {};
+    int width_ = 0;
+    bool built_ = false;
+    std::vector<int> anchors_;  // Допустимые якоря (y * width + x), порядок меняется при удалении
+    std::vector<int> slot_;     // Позиция якоря в anchors_ или -1
+};
+
+const int MAX_OBSTACLE_LENGTH = 5;
+const int QUICK_PLACEMENT_TRIES = 8;  // Случайных проб до построения индекса
+
+// Функция выбора места для фигуры: пока индекса нет, несколько случайных проб (на свободной
+// парковке они почти всегда удачны), затем индекс - выбор без повторных попыток.
+// В обоих случаях место равновероятно среди допустимых; false - мест не осталось
+template <class Fits>
+bool choosePlacement(PlacementIndex& ix, const PieceShape& shape, int width, int cells, Fits fits,
+                     ParkingRng& rng, int* x, int* y) {
+    if (!ix.built()) {
+        if (shape.maxX >= shape.minX && shape.maxY >= shape.minY) {
+            for (int t = 0; t < QUICK_PLACEMENT_TRIES; t++) {
+                int ax = shape.minX + randomInt(rng, shape.maxX - shape.minX + 1);
+                int ay = shape.minY + randomInt(rng, shape.maxY - shape.minY + 1);
+                if (fits(ax, ay)) {
+                    *x = ax;
+                    *y = ay;
+                    return true;
+                }
+            }
+        }
+        ix.build(shape, width, cells, fits);
+    }
+    if (ix.size() == 0) return false;
+    ix.sample(rng, x, y);
+    return true;
+}
+
+// Форма препятствия: не на крайних строках (горизонтальное) или столбцах (вертикальное)
+template <class B>
+inline PieceShape obstacleShape(const B& board, int length, bool horizontal) {
+    if (horizontal) return PieceShape{1, 0, length, 0, board.width() - length, 1, board.height() - 2};
+    return PieceShape{0, 1, length, 1, board.width() - 2, 0, board.height() - length};
+}
+
+// Форма машины с головой в якоре: клетки идут от головы по направлению машины
+template <class B>
+inline PieceShape carShape(const B& board, Direction dir, int length) {
+    int dx, dy;
+    directionDelta(dir, &dx, &dy);
+    if (dir == UP || dir == DOWN) return PieceShape{dx, dy, length, 0, board.width() - 1, 0, board.height() - length};
+    return PieceShape{dx, dy, length, 0, board.width() - length, 0, board.height() - 1};
+}
+
+// Функция генерации count препятствий (в p.obstacles должно быть место под count штук).
+// Длина и ориентация выбираются случайно; если такое препятствие уже некуда поставить,
+// берется более короткое, затем другая ориентация
+template <class B, class S>
+void placeObstacles(const B& board, S& p, int count, ParkingRng& rng) {
+    p.obstacleCount = 0;
+    maskClearAll(p.obstacleMask);
+
+    // Индексы по формам: [горизонтальное][длина - 1]; хранятся между вызовами, чтобы не выделять память
+    static thread_local PlacementIndex index[2][MAX_OBSTACLE_LENGTH];
+    for (auto& row : index)
+        for (PlacementIndex& ix : row) ix.reset();
+
+    for (int i = 0; i < count; i++) {
+        Obstacle obs;
+        obs.length = 1 + randomInt(rng, MAX_OBSTACLE_LENGTH); // Длина от 1 до 5
+        obs.isHorizontal = randomInt(rng, 2) == 0; // Случайная ориентация
+
+        bool placed = false;
+        for (int k = 0; k < 2 && !placed; k++) {
+            bool horizontal = k == 0 ? obs.isHorizontal : !obs.isHorizontal;
+            for (int len = obs.length; len >= 1 && !placed; len--) {
+                PieceShape shape = obstacleShape(board, len, horizontal);
+                auto fits = [&](int x, int y) {
+                    for (int j = 0; j < len; j++)
+                        if (!cellFree(board, p, x + j * shape.dx, y + j * shape.dy)) return false;
+                    return true;
+                };
+                placed = choosePlacement(index[horizontal][len - 1], shape, board.width(), board.cellCount(),
+                                         fits, rng, &obs.x, &obs.y);
+                if (placed) {
+                    obs.length = len;
+                    obs.isHorizontal = horizontal;
+                }
+            }
+        }
+        if (!placed) break; // На парковке не осталось места даже для препятствия в одну клетку
+
+        p.obstacles[p.obstacleCount++] = obs;
+        for (int j = 0; j < obs.length; j++) {
+            int ox = obs.isHorizontal ? obs.x + j : obs.x;
+            int oy = obs.isHorizontal ? obs.y : obs.y + j;
+            maskSet(p.obstacleMask, oy * board.width() + ox);
+            if (board.isExitCell(ox, oy)) continue; // Выезды остаются свободными
+            for (auto& row : index)
+                for (PlacementIndex& ix : row)
+                    if (ix.built()) ix.removeCovering(ox, oy);
+        }
+    }
+}
+
+// Функция проверки, что машина целиком стоит на свободных клетках парковки и не занимает выезды
+template <class B, class S>
+inline bool carFitsEmpty(const B& board, const S& p, const Car& car) {
+    for (int i = 0; i < car.length; i++) {
+        int cx, cy;
+        carCell(car, i, &cx, &cy);
+        BoardCell c = board.cell(cx, cy);
+        if (c.index < 0 || c.exit) return false;
+        if (maskTest(p.obstacleMask, c.index) || maskTest(p.carMask, c.index)) return false;
+    }
+    return true;
+}
+
+// Функция добора машин длины 2 до count, когда случайная расстановка уперлась в тупик: машина
+// длины 2 - домино на свободных клетках (не препятствия и не выезды), поэтому наибольшая
+// расстановка - наибольшее паросочетание соседних клеток. Уже поставленные машины - начальное
+// паросочетание, каждый увеличивающий путь (Кун) сдвигает часть машин и освобождает место еще
+// под одну. Машины, которых путь не коснулся, остаются на месте; остальные ставятся заново
+// со случайной головой. Машин меньше count, только если больше не помещается ни при какой расстановке.
+template <class B, class S>
+void completeCarsByMatching(const B& board, S& p, int count, ParkingRng& rng) {
+    const int w = board.width(), h = board.height(), cells = board.cellCount();
+    static thread_local std::vector<int> mate, seen, stack;
+    static thread_local std::vector<char> freeCell;
+    mate.assign(cells, -1);
+    seen.assign(cells, 0);
+    freeCell.assign(cells, 0);
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++) {
+            BoardCell c = board.cell(x, y);
+            freeCell[c.index] = !c.exit && !maskTest(p.obstacleMask, c.index);
+        }
+    for (int i = 0; i < p.carCount; i++) {
+        int ax, ay, bx, by;
+        carCell(p.cars[i], 0, &ax, &ay);
+        carCell(p.cars[i], 1, &bx, &by);
+        mate[ay * w + ax] = by * w + bx;
+        mate[by * w + bx] = ay * w + ax;
+    }
+
+    // Увеличивающий путь от свободной клетки u (клетки с четной x + y) поиском в глубину без рекурсии:
+    // в стеке клетки u пути и номер следующего соседа
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    int stamp = 0, matched = p.carCount;
+    int start = randomInt(rng, cells); // Первая клетка обхода случайна, чтобы добор не тянулся к углу
+    for (int k = 0; k < cells && matched < count; k++) {
+        int root = (start + k) % cells;
+        if (!freeCell[root] || mate[root] >= 0 || (root % w + root / w) % 2 != 0) continue;
+        stamp++;
+        stack.clear();
+        stack.push_back(root);
+        stack.push_back(0);
+        int freeEnd = -1;
+        while (!stack.empty() && freeEnd < 0) {
+            int u = stack[stack.size() - 2];
+            int& next = stack.back();
+            if (next == 4) {
+                stack.resize(stack.size() - 2);
+                continue;
+            }
+            const int* d = dirs[next++];
+            int vx = u % w + d[0], vy = u / w + d[1];
+            if (vx < 0 || vx >= w || vy < 0 || vy >= h) continue;
+            int v = vy * w + vx;
+            if (!freeCell[v] || seen[v] == stamp) continue;
+            seen[v] = stamp;
+            if (mate[v] < 0) {
+                freeEnd = v;
+            } else {
+                stack.push_back(mate[v]);
+                stack.push_back(0);
+            }
+        }
+        if (freeEnd < 0) continue;
+        // Перестановка пар вдоль пути: каждая клетка u в стеке берет клетку, через которую шли дальше
+        for (int i = (int)stack.size(); i >= 2; i -= 2) {
+            int u = stack[i - 2];
+            int v = freeEnd;
+            freeEnd = mate[u];
+            mate[u] = v;
+            mate[v] = u;
+        }
+        matched++;
+    }
+
+    // Машины, пары которых не изменились, сохраняют номер и направление; новые пары - в конец
+    int kept = 0;
+    for (int i = 0; i < p.carCount; i++) {
+        int ax, ay, bx, by;
+        carCell(p.cars[i], 0, &ax, &ay);
+        carCell(p.cars[i], 1, &bx, &by);
+        if (mate[ay * w + ax] != by * w + bx) continue;
+        p.cars[kept++] = p.cars[i];
+        mate[ay * w + ax] = mate[by * w + bx] = -2; // Пара уже стоит
+    }
+    p.carCount = kept;
+    for (int a = 0; a < cells && p.carCount < count; a++) {
+        if (mate[a] < a) continue; // Пары нет, она уже стоит или учтена с другой клетки
+        bool flip = randomInt(rng, 2) != 0;
+        int head = flip ? mate[a] : a, tail = flip ? a : mate[a];
+        Car car;
+        car.length = 2;
+        car.exited = false;
+        car.x = (int16_t)(head % w);
+        car.y = (int16_t)(head / w);
+        int dx = tail % w - head % w, dy = tail / w - head / w;
+        car.dir = dx > 0 ? RIGHT : dx < 0 ? LEFT : dy > 0 ? DOWN : UP;
+        p.cars[p.carCount++] = car;
+    }
+    clearCars(p);
+    for (int i = 0; i < p.carCount; i++) addCar(board, p, p.cars[i]);
+}
+
+// Функция генерации count машин поверх препятствий (в p.cars должно быть место под count штук).
+// Направление выбирается случайно, место - из индекса свободных мест для этого направления;
+// если свободных мест не осталось ни в одном направлении раньше count, машины добираются
+// наибольшим паросочетанием (completeCarsByMatching)
+template <class B, class S>
+void placeCars(const B& board, S& p, int count, ParkingRng& rng) {
+    p.carCount = 0;
+    p.moves = 0;
+    clearCars(p);
+
+    static thread_local PlacementIndex index[4]; // По направлениям
+    for (PlacementIndex& ix : index) ix.reset();
+
+    for (int i = 0; i < count; i++) {
+        Car car;
+        car.length = 2; // Длина 2
+        car.dir = static_cast<Direction>(randomInt(rng, 4)); // Случайное направление
+        car.exited = false;
+
+        bool placed = false;
+        int headX = 0, headY = 0;
+        for (int k = 0; k < 4 && !placed; k++) {
+            Car probe = car;
+            probe.dir = static_cast<Direction>((car.dir + k) % 4);
+            auto fits = [&](int x, int y) {
+                probe.x = x;
+                probe.y = y;
+                return carFitsEmpty(board, p, probe);
+            };
+            placed = choosePlacement(index[probe.dir], carShape(board, probe.dir, car.length), board.width(),
+                                     board.cellCount(), fits, rng, &headX, &headY);
+            if (placed) car.dir = probe.dir;
+        }
+        if (!placed) { // Случайная расстановка уперлась в тупик
+            completeCarsByMatching(board, p, count, rng);
+            return;
+        }
+
+        car.x = (int16_t)headX;
+        car.y = (int16_t)headY;
+        p.cars[p.carCount++] = car;
+        addCar(board, p, p.cars[p.carCount - 1]);
+        for (int j = 0; j < car.length; j++) {
+            int cx, cy;
+            carCell(car, j, &cx, &cy);
+            for (PlacementIndex& ix : index)
+                if (ix.built()) ix.removeCovering(cx, cy);
+        }
+    }
+}
+
+} // namespace rules
@@ -0,0 +1,164 @@
+#include "hint_engine.h"
+
+#include <chrono>
+
+HintEngine::HintEngine(size_t nodeLimit) : nodeLimit_(nodeLimit) {
+    worker_ = std::thread(&HintEngine::workerLoop, this);
+}
+
+HintEngine::~HintEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        cancel_ = true;
+    }
+    wake_.notify_all();
+    ready_.notify_all();
+    worker_.join();
+}
+
+void HintEngine::setReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    onReady_ = callback;
+}
+
+void HintEngine::newLevel(const Parking& p) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_.clear();
+    }
+    setBoard(p);
+}
+
+// Функция смены расстановки: уже решенная отвечается из кэша, иначе решатель начинает заново
+void HintEngine::setBoard(const Parking& p) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    board_ = p;
+    boardKey_ = parkingStateKey(p);
+    generation_++;
+    cancel_ = true; // Поиск по прежней расстановке больше не нужен
+
+    Hint h;
+    bool known = lookupLocked(boardKey_, &h);
+    if (known) {
+        cacheHits_++;
+        solvedGeneration_ = generation_;
+        ready_.notify_all();
+    }
+    // Быстрое решение из кэша еще уточняется до кратчайшего
+    idle_ = known && (h.optimal || h.status != SOLVE_FOUND);
+    if (!idle_) wake_.notify_one();
+}
+
+void HintEngine::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    idle_ = true;
+    cancel_ = true;
+}
+
+bool HintEngine::lookupLocked(uint64_t key, Hint* out) {
+    auto it = cache_.find(key);
+    if (it == cache_.end()) return false;
+    *out = it->second;
+    return true;
+}
+
+bool HintEngine::hint(Hint* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (solvedGeneration_ != generation_) return false;
+    return lookupLocked(boardKey_, out);
+}
+
+bool HintEngine::waitHint(Hint* out, double timeoutSeconds) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait_for(lock, std::chrono::duration<double>(timeoutSeconds),
+                    [&] { return stopping_ || solvedGeneration_ == generation_; });
+    if (solvedGeneration_ != generation_) return false;
+    return lookupLocked(boardKey_, out);
+}
+
+// Функция запоминания решения: каждая расстановка на пути получает свой следующий ход
+void HintEngine::storeSolution(const Parking& start, const SolveResult& r) {
+    if (cache_.size() + r.moves.size() + 1 > HINT_CACHE_LIMIT) cache_.clear();
+
+    Hint h;
+    h.status = r.status;
+    h.optimal = r.optimal;
+    if (r.status != SOLVE_FOUND) {
+        cache_[parkingStateKey(start)] = h;
+        return;
+    }
+
+    Parking p = start;
+    for (size_t i = 0; i <= r.moves.size(); i++) {
+        h.remaining = (int)(r.moves.size() - i);
+        h.move = i < r.moves.size() ? r.moves[i] : SolverMove{-1, MOVE_FORWARD};
+        uint64_t key = parkingStateKey(p);
+        auto it = cache_.find(key);
+        if (it == cache_.end() || !it->second.optimal) cache_[key] = h; // Кратчайший путь не заменяется
+        if (i < r.moves.size()) applyCarAction(p, &p.cars[h.move.car], h.move.action);
+    }
+}
+
+// Функция публикации решения для расстановки номер generation
+void HintEngine::publish(const Parking& start, const SolveResult& r, uint64_t generation) {
+    std::function<void()> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        solves_++;
+        storeSolution(start, r);
+
+        // Расстановка могла смениться, пока шел поиск, но оказаться на найденном пути
+        Hint h;
+        if (generation != generation_ && lookupLocked(boardKey_, &h)) {
+            if (h.optimal || h.status != SOLVE_FOUND) idle_ = true;
+            generation = generation_;
+        }
+        if (generation == generation_) {
+            solvedGeneration_ = generation;
+            ready_.notify_all();
+            callback = onReady_;
+        }
+    }
+    if (callback) callback();
+}
+
+// Функция потока решателя: решает последнюю расстановку, пока ее не сменят
+void HintEngine::workerLoop() {
+    Parking p;
+    for (;;) {
+        uint64_t generation;
+        bool answered;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || !idle_; });
+            if (stopping_) return;
+            p = board_;
+            generation = generation_;
+            answered = solvedGeneration_ == generation_; // Быстрое решение уже в кэше
+            idle_ = true;
+            cancel_ = false;
+        }
+
+        if (!answered) {
+            SolveResult quick = solveParking(p, HINT_QUICK_NODE_LIMIT, false, &cancel_);
+            if (quick.status == SOLVE_CANCELLED) {
+                cancelled_++;
+                continue;
+            }
+            if (quick.status != SOLVE_LIMIT) {
+                publish(p, quick, generation);
+                if (quick.optimal || quick.status != SOLVE_FOUND) continue;
+            }
+            if (cancel_) continue; // Расстановка сменилась во время быстрого поиска
+        }
+
+        SolveResult r = solveParking(p, nodeLimit_, true, &cancel_);
+        if (r.status == SOLVE_CANCELLED) {
+            cancelled_++;
+            continue;
+        }
+        publish(p, r, generation);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+// Подсказки: решатель работает в отдельном потоке и решает текущую расстановку, пока игрок думает.
+// Главный поток только сообщает о новой расстановке (setBoard) и забирает готовый ход (hint),
+// ни то ни другое не ждет решателя. Сначала публикуется быстрое решение (первое найденное,
+// единицы миллисекунд), затем оно заменяется кратчайшим. Ход по подсказке, отмена хода или
+// возврат к уже решенной расстановке отвечаются сразу из кэша: каждая расстановка на найденном
+// пути запоминается вместе со следующим ходом (остаток кратчайшего пути - тоже кратчайший путь).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "parking.h"
+#include "solver.h"
+
+const size_t HINT_CACHE_LIMIT = 1 << 16;      // Расстановок в кэше, после - кэш очищается
+const size_t HINT_QUICK_NODE_LIMIT = 20000;   // Лимит узлов быстрого (не кратчайшего) решения
+
+// Подсказка для одной расстановки
+struct Hint {
+    SolveStatus status = SOLVE_UNSOLVABLE; // SOLVE_FOUND - move содержит следующий ход
+    SolverMove move = {-1, MOVE_FORWARD};
+    int remaining = 0;       // Ходов до победы по найденному решению
+    bool optimal = false;    // Решение доказанно кратчайшее
+};
+
+class HintEngine {
+public:
+    explicit HintEngine(size_t nodeLimit = DEFAULT_SOLVER_NODE_LIMIT);
+    ~HintEngine();
+
+    HintEngine(const HintEngine&) = delete;
+    HintEngine& operator=(const HintEngine&) = delete;
+
+    // Новый уровень: кэш прежнего уровня больше не нужен
+    void newLevel(const Parking& p);
+    // Текущая расстановка изменилась: поиск по прежней отменяется (возврат без ожидания)
+    void setBoard(const Parking& p);
+    // Остановка поиска без новой расстановки (например, выход в меню)
+    void cancel();
+
+    // Подсказка для последней расстановки из setBoard (false - еще не готова)
+    bool hint(Hint* out);
+    // Ожидание подсказки (для замеров и инструментов, не для главного цикла игры)
+    bool waitHint(Hint* out, double timeoutSeconds);
+
+    // Вызывается из потока решателя, когда подсказка для текущей расстановки готова или
+    // уточнена до кратчайшей (игра будит главный цикл событием SDL)
+    void setReadyCallback(std::function<void()> callback);
+
+    uint64_t solves() const { return solves_; }          // Законченных поисков
+    uint64_t cancelled() const { return cancelled_; }    // Прерванных поисков
+    uint64_t cacheHits() const { return cacheHits_; }    // Расстановок, отвеченных из кэша без поиска
+
+private:
+    void workerLoop();
+    void publish(const Parking& start, const SolveResult& r, uint64_t generation);
+    void storeSolution(const Parking& start, const SolveResult& r);
+    bool lookupLocked(uint64_t key, Hint* out);
+
+    size_t nodeLimit_;
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable wake_;   // Новая расстановка или остановка
+    std::condition_variable ready_;  // Подсказка для текущей расстановки готова
+    std::atomic<bool> cancel_{false};
+    std::function<void()> onReady_;
+    bool stopping_ = false;
+
+    // Текущая расстановка (под mutex_)
+    Parking board_;
+    uint64_t boardKey_ = 0;
+    uint64_t generation_ = 0;        // Номер расстановки, растет при каждом setBoard
+    uint64_t solvedGeneration_ = 0;  // Для какой расстановки готова подсказка
+    bool idle_ = true;               // Нет расстановки, которую нужно решать
+    std::unordered_map<uint64_t, Hint> cache_;
+
+    std::atomic<uint64_t> solves_{0}, cancelled_{0}, cacheHits_{0};
+};
@@ -0,0 +1,196 @@
+#include "level_generator.h"
+#include "solver.h"
+
+#include <chrono>
+
+bool DifficultyBand::contains(const DifficultyMetrics& m) const {
+    return m.status == SOLVE_FOUND &&
+           m.optimalMoves >= minMoves && m.optimalMoves <= maxMoves &&
+           m.blockingMoves >= minBlocking && m.blockingMoves <= maxBlocking &&
+           m.branchingFactor >= minBranching && m.branchingFactor <= maxBranching &&
+           m.deadEndRatio >= minDeadEnd && m.deadEndRatio <= maxDeadEnd;
+}
+
+DifficultyBand defaultBand(int difficulty) {
+    DifficultyBand band;
+    switch (difficulty) {
+        case 1:
+            band.maxBlocking = 0;
+            break;
+        case 2:
+            band.minBlocking = 1;
+            band.maxBlocking = 2;
+            break;
+        default:
+            band.minBlocking = 3;
+            break;
+    }
+    return band;
+}
+
+// Функция инициализации генератора для кандидата номер attempt уровня с зерном seed
+void seedLevelRng(ParkingRng& rng, uint64_t seed, uint64_t attempt) {
+    rng.seed(seed, attempt);
+}
+
+LevelGenerator::LevelGenerator(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    for (int i = 0; i < threads; i++)
+        workers_.emplace_back(&LevelGenerator::workerLoop, this);
+}
+
+LevelGenerator::~LevelGenerator() {
+    cancelRequest();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& t : workers_) t.join();
+}
+
+// Функция ожидания заданий рабочим потоком
+void LevelGenerator::workerLoop() {
+    uint64_t seenJob = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || jobId_ != seenJob; });
+            if (stopping_) return;
+            seenJob = jobId_;
+        }
+
+        runJob();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
+
+// Функция перебора кандидатов: каждый поток берет следующий номер, пока не найден решаемый с меньшим
+void LevelGenerator::runJob() {
+    Parking candidate;
+    ParkingRng rng;
+
+    for (;;) {
+        int attempt;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            attempt = nextAttempt_++;
+            if (attempt >= maxAttempts_ || attempt >= bestAttempt_ || cancel_.load(std::memory_order_relaxed)) return;
+        }
+
+        seedLevelRng(rng, seed_, (uint64_t)attempt);
+        generateParking(candidate, difficulty_, rng);
+        DifficultyMetrics m;
+        bool fits;
+        if (band_) {
+            m = measureDifficulty(candidate, METRICS_NODE_LIMIT);
+            fits = band_->contains(m);
+        } else {
+            SolveResult r = solveParking(candidate, SOLVABILITY_NODE_LIMIT, false);
+            fits = r.status == SOLVE_FOUND;
+            m.optimalMoves = (int)r.moves.size();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        attemptsDone_++;
+        if (fits && attempt < bestAttempt_) {
+            if (bestAttempt_ == maxAttempts_)
+                firstSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+            bestAttempt_ = attempt;
+            bestLength_ = m.optimalMoves;
+            bestMetrics_ = m;
+            *out_ = candidate;
+        }
+    }
+}
+
+// Функция генерации решаемой парковки
+bool LevelGenerator::generateSolvable(Parking& out, int difficulty, uint64_t seed,
+                                      GenerationStats* stats, int maxAttempts) {
+    return run(out, difficulty, nullptr, seed, stats, maxAttempts);
+}
+
+// Функция генерации парковки с метриками сложности в диапазоне band
+bool LevelGenerator::generateTargeted(Parking& out, int difficulty, const DifficultyBand& band, uint64_t seed,
+                                      GenerationStats* stats, int maxAttempts) {
+    return run(out, difficulty, &band, seed, stats, maxAttempts);
+}
+
+bool LevelGenerator::run(Parking& out, int difficulty, const DifficultyBand* band, uint64_t seed,
+                         GenerationStats* stats, int maxAttempts) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> job(jobMutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    difficulty_ = difficulty;
+    band_ = band;
+    start_ = start;
+    seed_ = seed;
+    maxAttempts_ = maxAttempts;
+    nextAttempt_ = 0;
+    bestAttempt_ = maxAttempts;
+    attemptsDone_ = 0;
+    bestLength_ = 0;
+    firstSeconds_ = 0;
+    bestMetrics_ = DifficultyMetrics();
+    out_ = &out;
+    busy_ = (int)workers_.size();
+    jobId_++;
+    wake_.notify_all();
+    done_.wait(lock, [&] { return busy_ == 0; });
+    out_ = nullptr;
+    band_ = nullptr;
+
+    if (stats) {
+        stats->attempts = attemptsDone_;
+        stats->solutionLength = bestLength_;
+        stats->attempt = bestAttempt_ < maxAttempts ? bestAttempt_ : -1;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats->firstSeconds = firstSeconds_;
+        stats->metrics = bestMetrics_;
+    }
+    return bestAttempt_ < maxAttempts && !cancel_.load();
+}
+
+void LevelGenerator::requestTargeted(int difficulty, const DifficultyBand& band, uint64_t seed,
+                                     std::function<void()> onReady, int maxAttempts) {
+    cancelRequest();
+    requestBand_ = band;
+    requestReady_.store(false);
+    requestActive_ = true;
+    request_ = std::thread([this, difficulty, seed, onReady, maxAttempts] {
+        requestFound_ = run(requestOut_, difficulty, &requestBand_, seed, &requestStats_, maxAttempts);
+        if (!requestFound_ && !cancel_.load()) {
+            // Диапазон не достигнут: решаемый уровень того же зерна (попытки и время суммируются)
+            GenerationStats solvable;
+            run(requestOut_, difficulty, nullptr, seed, &solvable, DEFAULT_GENERATION_ATTEMPTS);
+            solvable.attempts += requestStats_.attempts;
+            solvable.seconds += requestStats_.seconds;
+            requestStats_ = solvable;
+        }
+        requestReady_.store(true, std::memory_order_release);
+        if (onReady && !cancel_.load()) onReady();
+    });
+}
+
+bool LevelGenerator::takeResult(Parking& out, GenerationStats* stats, bool* inBand) {
+    if (!requestActive_ || !requestReady_.load(std::memory_order_acquire)) return false;
+    request_.join();
+    requestActive_ = false;
+    if (requestStats_.attempt >= 0) out = requestOut_;
+    if (stats) *stats = requestStats_;
+    if (inBand) *inBand = requestFound_;
+    return true;
+}
+
+void LevelGenerator::cancelRequest() {
+    if (request_.joinable()) {
+        cancel_.store(true);
+        request_.join();
+        cancel_.store(false);
+    }
+    requestActive_ = false;
+}
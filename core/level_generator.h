@@ -0,0 +1,119 @@
+#pragma once
+// Генерация заведомо решаемых уровней (и уровней с заданными метриками сложности) на пуле потоков
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "parking.h"
+#include "solver.h"
+
+// Статистика одной генерации
+struct GenerationStats {
+    int attempts = 0;         // Сколько кандидатов сгенерировано и проверено
+    int solutionLength = 0;   // Длина найденного решения
+    int attempt = -1;         // Номер выбранного кандидата: уровень = seedLevelRng(seed, attempt) + generateParking
+    double seconds = 0;       // Время от запроса до результата
+    double firstSeconds = 0;  // Время до первого подходящего кандидата (дальше ждем кандидатов с меньшим номером)
+    DifficultyMetrics metrics; // Метрики выбранного уровня (только generateTargeted)
+};
+
+// Диапазон метрик сложности, в который должен попасть уровень
+struct DifficultyBand {
+    int minMoves = 0, maxMoves = 1 << 30;
+    int minBlocking = 0, maxBlocking = 1 << 30;
+    double minBranching = 0, maxBranching = 1e9;
+    double minDeadEnd = 0, maxDeadEnd = 1;
+
+    bool contains(const DifficultyMetrics& m) const;
+};
+
+// Диапазон по умолчанию для сложности игры: 1 - машины выезжают по очереди без помех,
+// 2 - одной-двум машинам нужно уступить дорогу, 3 - три и больше лишних хода на пропуск машин
+DifficultyBand defaultBand(int difficulty);
+
+const int DEFAULT_GENERATION_ATTEMPTS = 20000; // Лимит кандидатов на один уровень
+const size_t SOLVABILITY_NODE_LIMIT = 20000;   // Лимит узлов решателя на одного кандидата
+const size_t METRICS_NODE_LIMIT = 20000;       // Лимит узлов при оценке сложности кандидата
+
+// Пул потоков, которые генерируют кандидатов generateParking и проверяют их решателем.
+// Потоки создаются один раз, чтобы запрос уровня не платил за их запуск.
+class LevelGenerator {
+public:
+    explicit LevelGenerator(int threads = 0);  // 0 - по числу ядер
+    ~LevelGenerator();
+
+    LevelGenerator(const LevelGenerator&) = delete;
+    LevelGenerator& operator=(const LevelGenerator&) = delete;
+
+    // Генерация решаемой парковки. Результат зависит только от seed: из всех кандидатов
+    // берется решаемый с наименьшим номером. Возвращает false, если лимит попыток исчерпан.
+    bool generateSolvable(Parking& out, int difficulty, uint64_t seed,
+                          GenerationStats* stats = nullptr, int maxAttempts = DEFAULT_GENERATION_ATTEMPTS);
+    // Генерация парковки с метриками решателя в заданном диапазоне (difficulty задает число машин
+    // и препятствий кандидатов). Так же детерминирована: берется подходящий кандидат с наименьшим номером.
+    bool generateTargeted(Parking& out, int difficulty, const DifficultyBand& band, uint64_t seed,
+                          GenerationStats* stats = nullptr, int maxAttempts = DEFAULT_GENERATION_ATTEMPTS);
+
+    // Запрос generateTargeted для главного цикла игры: генерация идет в отдельном потоке, вызов
+    // возвращается сразу. Если за maxAttempts кандидатов диапазон не достигнут, берется уровень
+    // generateSolvable того же зерна. onReady вызывается из потока запроса, когда результат готов
+    // (игра будит главный цикл событием SDL). Новый запрос отменяет прежний, если тот еще не забран.
+    void requestTargeted(int difficulty, const DifficultyBand& band, uint64_t seed,
+                         std::function<void()> onReady = nullptr, int maxAttempts = DEFAULT_GENERATION_ATTEMPTS);
+    // Результат запроса (false - не готов или запроса нет); inBand - уровень попал в диапазон.
+    // stats->attempt < 0 - не нашлось и решаемого уровня, out не изменена.
+    bool takeResult(Parking& out, GenerationStats* stats, bool* inBand);
+    bool requestPending() const { return requestActive_; }
+    // Отмена запроса: потоки бросают перебор после текущих кандидатов
+    void cancelRequest();
+
+    int threadCount() const { return (int)workers_.size(); }
+
+private:
+    void workerLoop();
+    void runJob();
+    bool run(Parking& out, int difficulty, const DifficultyBand* band, uint64_t seed,
+             GenerationStats* stats, int maxAttempts);
+
+    std::vector<std::thread> workers_;
+    std::mutex jobMutex_;            // Одно задание за раз (запрос и синхронные вызовы)
+    std::mutex mutex_;
+    std::condition_variable wake_;   // Новое задание или остановка
+    std::condition_variable done_;   // Все потоки закончили задание
+    bool stopping_ = false;
+    uint64_t jobId_ = 0;
+    int busy_ = 0;
+
+    // Текущее задание (меняется только между заданиями под mutex_)
+    int difficulty_ = 1;
+    uint64_t seed_ = 0;
+    int maxAttempts_ = 0;
+    const DifficultyBand* band_ = nullptr; // nullptr - достаточно решаемости
+    std::chrono::steady_clock::time_point start_;
+    int nextAttempt_ = 0;            // Следующий номер кандидата (под mutex_)
+    int bestAttempt_ = 0;            // Наименьший подходящий номер (под mutex_)
+    int attemptsDone_ = 0;
+    int bestLength_ = 0;
+    double firstSeconds_ = 0;        // Когда найден первый подходящий кандидат
+    DifficultyMetrics bestMetrics_;
+    Parking* out_ = nullptr;
+    std::atomic<bool> cancel_{false};
+
+    // Асинхронный запрос (requestTargeted/takeResult/cancelRequest вызывает один поток)
+    std::thread request_;
+    bool requestActive_ = false;
+    std::atomic<bool> requestReady_{false};
+    DifficultyBand requestBand_;
+    Parking requestOut_;
+    GenerationStats requestStats_;
+    bool requestFound_ = false;
+};
+
+// Функция инициализации генератора для кандидата номер attempt уровня с зерном seed
+void seedLevelRng(ParkingRng& rng, uint64_t seed, uint64_t attempt);
@@ -0,0 +1,117 @@
+#include "level_pack.h"
+
+#include <string.h>
+
+static const char PACK_MAGIC[4] = {'P', 'K', 'L', 'V'};
+
+static void putU64(uint8_t* out, uint64_t v) {
+    for (int i = 0; i < 8; i++) out[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t getU64(const uint8_t* in) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)in[i] << (8 * i);
+    return v;
+}
+
+// Функция записи заголовка файла уровней
+bool writeLevelPackHeader(FILE* f, const LevelPackHeader& h) {
+    uint8_t buf[LEVEL_PACK_HEADER_BYTES] = {};
+    memcpy(buf, PACK_MAGIC, 4);
+    buf[4] = (uint8_t)h.version;
+    buf[5] = (uint8_t)h.difficulty;
+    buf[6] = (uint8_t)h.gridWidth;
+    buf[7] = (uint8_t)h.gridHeight;
+    putU64(buf + 8, h.firstSeed);
+    putU64(buf + 16, h.levelCount);
+    return fwrite(buf, 1, sizeof(buf), f) == sizeof(buf);
+}
+
+// Функция чтения заголовка файла уровней
+bool readLevelPackHeader(FILE* f, LevelPackHeader& h) {
+    uint8_t buf[LEVEL_PACK_HEADER_BYTES];
+    if (fread(buf, 1, sizeof(buf), f) != sizeof(buf)) return false;
+    if (memcmp(buf, PACK_MAGIC, 4) != 0) return false;
+    h.version = buf[4];
+    h.difficulty = buf[5];
+    h.gridWidth = buf[6];
+    h.gridHeight = buf[7];
+    h.firstSeed = getU64(buf + 8);
+    h.levelCount = getU64(buf + 16);
+    return h.version == LEVEL_PACK_VERSION && h.gridWidth == GRID_WIDTH && h.gridHeight == GRID_HEIGHT;
+}
+
+// Функция упаковки парковки в байты
+size_t encodeLevel(const Parking& p, uint8_t* out) {
+    uint8_t* o = out;
+    *o++ = (uint8_t)p.carCount;
+    *o++ = (uint8_t)p.obstacleCount;
+    for (int i = 0; i < p.carCount; i++) {
+        const Car& c = p.cars[i];
+        uint16_t v = (uint16_t)(c.x | (c.y << 6) | ((int)c.dir << 12) | ((c.length - 1) << 14));
+        *o++ = (uint8_t)v;
+        *o++ = (uint8_t)(v >> 8);
+    }
+    for (int i = 0; i < p.obstacleCount; i++) {
+        const Obstacle& ob = p.obstacles[i];
+        uint16_t v = (uint16_t)(ob.x | (ob.y << 6) | ((ob.isHorizontal ? 1 : 0) << 12) | ((ob.length - 1) << 13));
+        *o++ = (uint8_t)v;
+        *o++ = (uint8_t)(v >> 8);
+    }
+    return (size_t)(o - out);
+}
+
+// Функция распаковки парковки из байт
+size_t decodeLevel(const uint8_t* in, size_t size, Parking& p) {
+    if (size < 2) return 0;
+    int carCount = in[0], obstacleCount = in[1];
+    if (carCount > MAX_CARS || obstacleCount > MAX_OBSTACLES) return 0;
+    size_t bytes = 2 + 2 * (size_t)(carCount + obstacleCount);
+    if (size < bytes) return 0;
+
+    const uint8_t* carBytes = in + 2;
+    const uint8_t* obstacleBytes = carBytes + 2 * carCount;
+    p.carCount = 0;
+    p.moves = 0;
+    clearCarMask(p);
+    p.obstacleCount = 0;
+    p.obstacleMask = 0;
+
+    // Сначала препятствия, затем машины (как в generateParking)
+    for (int i = 0; i < obstacleCount; i++) {
+        const uint8_t* r = obstacleBytes + 2 * i;
+        uint16_t v = (uint16_t)(r[0] | (r[1] << 8));
+        Obstacle ob;
+        ob.x = v & 63;
+        ob.y = (v >> 6) & 63;
+        ob.isHorizontal = (v >> 12) & 1;
+        ob.length = 1 + ((v >> 13) & 7);
+        for (int j = 0; j < ob.length; j++) {
+            int ox = ob.isHorizontal ? ob.x + j : ob.x;
+            int oy = ob.isHorizontal ? ob.y : ob.y + j;
+            if (!inGrid(ox, oy)) return 0;
+            p.obstacleMask |= cellBit(ox, oy);
+        }
+        p.obstacles[p.obstacleCount++] = ob;
+    }
+
+    for (int i = 0; i < carCount; i++) {
+        const uint8_t* r = carBytes + 2 * i;
+        uint16_t v = (uint16_t)(r[0] | (r[1] << 8));
+        Car car;
+        car.x = v & 63;
+        car.y = (v >> 6) & 63;
+        car.dir = static_cast<Direction>((v >> 12) & 3);
+        car.length = 1 + ((v >> 14) & 3);
+        car.exited = false;
+        // Машина целиком на парковке и не на выезде (generateParking их туда не ставит)
+        for (int j = 0; j < car.length; j++) {
+            int cx, cy;
+            carCell(car, j, &cx, &cy);
+            if (!inGrid(cx, cy) || isExitCell(cx, cy)) return 0;
+        }
+        p.cars[p.carCount++] = car;
+        addCarToMask(p, p.carCount - 1);
+    }
+    return bytes;
+}
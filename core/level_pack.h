@@ -0,0 +1,43 @@
+#pragma once
+// Упакованный файл заранее сгенерированных уровней
+//
+// Формат (все числа little-endian):
+//   заголовок 24 байта: "PKLV", версия, сложность, ширина и высота парковки,
+//                       зерно первого уровня (8 байт), число уровней (8 байт)
+//   уровни подряд в порядке зерен (зерно уровня = firstSeed + номер):
+//     1 байт - число машин, 1 байт - число препятствий,
+//     2 байта на машину:      x (6 бит) | y (6 бит) | направление (2 бита) | длина-1 (2 бита)
+//     2 байта на препятствие: x (6 бит) | y (6 бит) | горизонтальное (1 бит) | длина-1 (3 бита)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "parking.h"
+
+const int LEVEL_PACK_VERSION = 3;  // Меняется вместе с генерацией: 2 - xoshiro256**, 3 - выбор мест из индекса
+const size_t LEVEL_PACK_HEADER_BYTES = 24;
+// Максимальный размер одного уровня в файле
+const size_t MAX_LEVEL_RECORD_BYTES = 2 + 2 * (MAX_CARS + MAX_OBSTACLES);
+
+static_assert(GRID_WIDTH <= 64 && GRID_HEIGHT <= 64, "Координаты не помещаются в 6 бит");
+
+struct LevelPackHeader {
+    int version = LEVEL_PACK_VERSION;
+    int difficulty = 1;
+    int gridWidth = GRID_WIDTH;
+    int gridHeight = GRID_HEIGHT;
+    uint64_t firstSeed = 0;
+    uint64_t levelCount = 0;
+};
+
+// Функции записи и чтения заголовка (false - ошибка ввода-вывода или чужой файл)
+bool writeLevelPackHeader(FILE* f, const LevelPackHeader& h);
+bool readLevelPackHeader(FILE* f, LevelPackHeader& h);
+
+// Функция упаковки парковки, возвращает число записанных байт (не больше MAX_LEVEL_RECORD_BYTES)
+size_t encodeLevel(const Parking& p, uint8_t* out);
+// Функция распаковки парковки с пересчетом карты занятости, возвращает число
+// прочитанных байт или 0, если данные повреждены (в том числе препятствие или машина
+// выходит за парковку, машина стоит на выезде)
+size_t decodeLevel(const uint8_t* in, size_t size, Parking& p);
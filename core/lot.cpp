@@ -0,0 +1,176 @@
+#include "lot.h"
+#include "board_rules.h"
+
+#include <algorithm>
+#include <vector>
+
+// Состояние парковки (поля совпадают с Parking, чтобы работали общие правила)
+template <class B>
+struct LotState {
+    std::vector<Car> cars;
+    int carCount = 0;
+    std::vector<Obstacle> obstacles;
+    int obstacleCount = 0;
+    int moves = 0;
+
+    typename B::Mask obstacleMask = {};
+    typename B::Mask carMask = {};
+    typename B::Counts carCellCount = {};
+};
+
+template <class B>
+class Lot : public LotBase {
+public:
+    explicit Lot(const B& b) : board(b) {
+        if constexpr (B::DYNAMIC) {
+            s.obstacleMask = board.makeMask();
+            s.carMask = board.makeMask();
+            s.carCellCount = board.makeCounts();
+        }
+        cellHead.assign((board.width() + 2 * BOARD_MARGIN) * (board.height() + 2 * BOARD_MARGIN), -1);
+    }
+
+    int width() const override { return board.width(); }
+    int height() const override { return board.height(); }
+    int exitWidth() const override { return board.exitWidth(); }
+    bool compiled() const override { return !B::DYNAMIC; }
+
+    void generate(int difficulty, ParkingRng& rng) override {
+        s.carCount = 0;
+        rules::clearCars(s);
+
+        int numObstacles = rules::obstacleCountFor(board, difficulty);
+        s.obstacles.resize(numObstacles);
+        rules::placeObstacles(board, s, numObstacles, rng);
+
+        int numCars = rules::carCountFor(board, difficulty);
+        s.cars.resize(numCars);
+        rules::placeCars(board, s, numCars, rng);
+
+        exited = 0;
+        std::fill(cellHead.begin(), cellHead.end(), -1);
+        nodeNext.assign(s.carCount * MAX_SEGMENTS, -1);
+        nodePrev.assign(s.carCount * MAX_SEGMENTS, -1);
+        nodeCell.assign(s.carCount * MAX_SEGMENTS, -1);
+        for (int i = 0; i < s.carCount; i++) linkCar(i);
+    }
+
+    int carCount() const override { return s.carCount; }
+    const Car& car(int index) const override { return s.cars[index]; }
+    int obstacleCount() const override { return s.obstacleCount; }
+    const Obstacle& obstacle(int index) const override { return s.obstacles[index]; }
+    int moves() const override { return s.moves; }
+    int exitedCount() const override { return exited; }
+
+    bool isExitCell(int x, int y) const override { return board.isExitCell(x, y); }
+    bool isCellFree(int x, int y) const override { return rules::cellFree(board, s, x, y); }
+
+    int carsAt(int x, int y, int* out, int maxOut) const override {
+        int index = frameIndex(x, y);
+        if (index < 0) return 0;
+        // Порядок в списке зависит от истории ходов, поэтому номера упорядочиваются вставкой
+        int found = 0;
+        for (int node = cellHead[index]; node >= 0; node = nodeNext[node]) {
+            int car = node / MAX_SEGMENTS;
+            if (found == maxOut && (maxOut == 0 || car > out[found - 1])) continue;
+            int i = found < maxOut ? found++ : found - 1;
+            for (; i > 0 && out[i - 1] > car; i--) out[i] = out[i - 1];
+            out[i] = car;
+        }
+        return found;
+    }
+
+    bool canMove(int car, int dx, int dy) const override { return rules::canMove(board, s, s.cars[car], dx, dy); }
+
+    // Ход меняет только клетки одной машины: карта занятости, списки машин в клетках и счетчик выехавших
+    bool applyCarAction(int car, CarAction action) override {
+        if (!rules::applyAction(board, s, s.cars[car], action)) return false;
+        unlinkCar(car);
+        if (s.cars[car].exited) exited++;
+        else linkCar(car);
+        return true;
+    }
+
+    void undoCarAction(int car, CarAction action) override {
+        if (s.cars[car].exited) exited--;
+        else unlinkCar(car);
+        rules::undoAction(board, s, s.cars[car], action);
+        linkCar(car);
+    }
+
+    bool checkWin() const override { return exited == s.carCount; }
+
+private:
+    static const int MAX_SEGMENTS = MAX_LOT_CAR_LENGTH;
+
+    // Номер клетки в списках машин: парковка вместе с рамкой BOARD_MARGIN, где стоят
+    // выезжающие машины (-1 - за рамкой)
+    int frameIndex(int x, int y) const {
+        int frameW = board.width() + 2 * BOARD_MARGIN;
+        if (x < -BOARD_MARGIN || x >= board.width() + BOARD_MARGIN || y < -BOARD_MARGIN ||
+            y >= board.height() + BOARD_MARGIN)
+            return -1;
+        return (y + BOARD_MARGIN) * frameW + (x + BOARD_MARGIN);
+    }
+
+    // Функция добавления клеток машины в списки машин по клеткам
+    void linkCar(int car) {
+        const Car& c = s.cars[car];
+        for (int i = 0; i < c.length && i < MAX_SEGMENTS; i++) {
+            int cx, cy;
+            carCell(c, i, &cx, &cy);
+            int index = frameIndex(cx, cy);
+            if (index < 0) continue;
+            int node = car * MAX_SEGMENTS + i;
+            nodeCell[node] = index;
+            nodePrev[node] = -1;
+            nodeNext[node] = cellHead[index];
+            if (cellHead[index] >= 0) nodePrev[cellHead[index]] = node;
+            cellHead[index] = node;
+        }
+    }
+
+    // Функция удаления клеток машины из списков (по сохраненным клеткам, до хода)
+    void unlinkCar(int car) {
+        for (int node = car * MAX_SEGMENTS; node < (car + 1) * MAX_SEGMENTS; node++) {
+            int index = nodeCell[node];
+            if (index < 0) continue;
+            if (nodePrev[node] >= 0) nodeNext[nodePrev[node]] = nodeNext[node];
+            else cellHead[index] = nodeNext[node];
+            if (nodeNext[node] >= 0) nodePrev[nodeNext[node]] = nodePrev[node];
+            nodeCell[node] = -1;
+        }
+    }
+
+    B board;
+    LotState<B> s;
+    // Списки машин по клеткам парковки и рамки: узел car * MAX_SEGMENTS + i - i-я клетка машины car
+    std::vector<int> cellHead;   // Первый узел в клетке по frameIndex (-1 - пусто)
+    std::vector<int> nodeNext, nodePrev, nodeCell;
+    int exited = 0;              // Число выехавших машин (проверка победы за O(1))
+};
+
+// Размеры, собранные заранее, и парковка произвольного размера
+template struct Board<8, 8, 2>;
+template struct Board<10, 10, 2>;
+template struct Board<16, 16, 2>;
+template class Lot<Board8>;
+template class Lot<Board10>;
+template class Lot<Board16>;
+template class Lot<DynamicBoard>;
+
+// Функция выбора варианта по размеру
+std::unique_ptr<LotBase> createLot(int width, int height, int exitWidth) {
+    if (width < MIN_LOT_SIZE || width > MAX_LOT_SIZE || height < MIN_LOT_SIZE || height > MAX_LOT_SIZE)
+        return nullptr;
+    if (exitWidth < 0 || exitWidth / 2 >= BOARD_MARGIN) return nullptr;
+
+    if (exitWidth == 2 && width == height) {
+        switch (width) {
+            case 8:  return std::unique_ptr<LotBase>(new Lot<Board8>(Board8()));
+            case 10: return std::unique_ptr<LotBase>(new Lot<Board10>(Board10()));
+            case 16: return std::unique_ptr<LotBase>(new Lot<Board16>(Board16()));
+        }
+    }
+    return std::unique_ptr<LotBase>(new Lot<DynamicBoard>(DynamicBoard(width, height, exitWidth)));
+}
@@ -0,0 +1,47 @@
+#pragma once
+// Парковки других размеров: правила Board<W, H, ExitWidth> собраны заранее для 8x8, 10x10 и 16x16,
+// остальные размеры до MAX_LOT_SIZE x MAX_LOT_SIZE работают через DynamicBoard.
+// Нужный вариант выбирается во время работы по размеру.
+
+#include <memory>
+
+#include "parking.h"
+
+const int MIN_LOT_SIZE = 4;  // Наименьшая сторона парковки (препятствия не ставятся на границы)
+const int MAX_LOT_CAR_LENGTH = 4;  // Наибольшая длина машины в списках машин по клеткам
+// Наибольшее число машин в клетке: поворот не проверяет столкновений, но головы машин не совпадают,
+// поэтому клетку накрывают машина с головой в ней и до (длина - 1) машин с каждой из четырех сторон
+const int MAX_CARS_IN_CELL = 1 + 4 * (MAX_LOT_CAR_LENGTH - 1);
+
+// Общий интерфейс парковки произвольного размера (диспетчеризация по размеру)
+class LotBase {
+public:
+    virtual ~LotBase() {}
+
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+    virtual int exitWidth() const = 0;
+    virtual bool compiled() const = 0;  // Размер собран заранее (Board), а не DynamicBoard
+
+    virtual void generate(int difficulty, ParkingRng& rng) = 0;
+
+    virtual int carCount() const = 0;
+    virtual const Car& car(int index) const = 0;
+    virtual int obstacleCount() const = 0;
+    virtual const Obstacle& obstacle(int index) const = 0;
+    virtual int moves() const = 0;
+    virtual int exitedCount() const = 0;
+
+    virtual bool isExitCell(int x, int y) const = 0;
+    virtual bool isCellFree(int x, int y) const = 0;
+    // Машины в клетке парковки или рамки BOARD_MARGIN с выездами (после поворота их может быть
+    // несколько) в порядке номеров, возвращает их число; при нехватке места - maxOut младших
+    virtual int carsAt(int x, int y, int* out, int maxOut) const = 0;
+    virtual bool canMove(int car, int dx, int dy) const = 0;
+    virtual bool applyCarAction(int car, CarAction action) = 0;
+    virtual void undoCarAction(int car, CarAction action) = 0; // Только для хода, выполненного applyCarAction
+    virtual bool checkWin() const = 0;
+};
+
+// Создание парковки заданного размера; nullptr, если размер вне MIN_LOT_SIZE..MAX_LOT_SIZE
+std::unique_ptr<LotBase> createLot(int width, int height, int exitWidth = EXIT_WIDTH);
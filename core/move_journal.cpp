@@ -0,0 +1,38 @@
+#include "move_journal.h"
+
+MoveJournal::MoveJournal(int capacity) : ring_(capacity > 0 ? capacity : 1) {}
+
+void MoveJournal::clear() {
+    start_ = 0;
+    count_ = 0;
+    undoCount_ = 0;
+}
+
+JournalEntry MoveJournal::entry(int i) const {
+    uint16_t v = ring_[(start_ + i) % ring_.size()];
+    return {v >> 2, (CarAction)(v & 3)};
+}
+
+// Функция записи хода: новый ход заменяет ветку отмененных
+void MoveJournal::record(int car, CarAction action) {
+    if (car < 0 || car > MAX_JOURNAL_CAR) return;
+    count_ = undoCount_;
+    if (count_ == (int)ring_.size()) {
+        start_ = (start_ + 1) % ring_.size(); // Самый старый ход больше не отменить
+        count_--;
+        undoCount_--;
+    }
+    ring_[(start_ + count_) % ring_.size()] = (uint16_t)(car << 2 | action);
+    count_++;
+    undoCount_++;
+}
+
+JournalEntry MoveJournal::undo() {
+    if (!canUndo()) return {-1, MOVE_FORWARD};
+    return entry(--undoCount_);
+}
+
+JournalEntry MoveJournal::redo() {
+    if (!canRedo()) return {-1, MOVE_FORWARD};
+    return entry(undoCount_++);
+}
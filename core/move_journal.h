@@ -0,0 +1,47 @@
+#pragma once
+// Журнал отмены и повтора ходов. Хранится не снимок машин, а само действие (машина и вид
+// действия, 2 байта): прежнее положение восстанавливается обратным действием (undoCarAction),
+// повтор - тем же действием. Журнал - кольцо фиксированной длины: при переполнении
+// забываются самые старые ходы, поэтому память не растет со временем партии.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "parking.h"
+
+const int DEFAULT_JOURNAL_CAPACITY = 4096;  // 8 КБ
+const int MAX_JOURNAL_CAR = (1 << 14) - 1;  // Номер машины занимает 14 бит записи
+
+struct JournalEntry {
+    int car;
+    CarAction action;
+};
+
+class MoveJournal {
+public:
+    explicit MoveJournal(int capacity = DEFAULT_JOURNAL_CAPACITY);
+
+    void clear();
+    // Запись выполненного действия (отмененные ходы после него забываются)
+    void record(int car, CarAction action);
+
+    bool canUndo() const { return undoCount_ > 0; }
+    bool canRedo() const { return undoCount_ < count_; }
+    // Ход для отмены (вызывающий применяет undoCarAction) и ход для повтора (applyCarAction)
+    JournalEntry undo();
+    JournalEntry redo();
+
+    int undoCount() const { return undoCount_; }
+    int redoCount() const { return count_ - undoCount_; }
+    int capacity() const { return (int)ring_.size(); }
+    size_t memoryBytes() const { return ring_.size() * sizeof(uint16_t); }
+
+private:
+    JournalEntry entry(int i) const;
+
+    std::vector<uint16_t> ring_;  // номер машины << 2 | действие
+    int start_ = 0;               // Самый старый ход в кольце
+    int count_ = 0;               // Всего ходов (доступные для отмены, затем для повтора)
+    int undoCount_ = 0;
+};
@@ -0,0 +1,169 @@
+#include "parking.h"
+#include "board_rules.h"      // Правила, общие для парковок любого размера
+
+static constexpr ParkingBoard board{}; // Геометрия игровой парковки (только constexpr-таблицы)
+
+// Позиции выездов с парковки (центры сторон)
+const Point exits[4] = {
+    ParkingBoard::exits[0],  // Левый край
+    ParkingBoard::exits[1],  // Правый край
+    ParkingBoard::exits[2],  // Верхний край
+    ParkingBoard::exits[3]   // Нижний край
+};
+
+const uint64_t exitMask = ParkingBoard::exitMask;
+
+// Функция проверки, находится ли клетка на выезде (в том числе за пределами парковки)
+bool isExitCell(int x, int y) {
+    return ParkingBoard::isExitCell(x, y);
+}
+
+// Функция расчета клеток машины после сдвига на (dx, dy)
+Footprint carFootprint(const Car& car, int dx, int dy) {
+    return rules::footprint(board, car, dx, dy);
+}
+
+// Функция добавления машины в карту занятости (по номеру: индекс клеток берет номер машины из p.cars)
+void addCarToMask(Parking& p, int car) {
+    rules::addCar(board, p, p.cars[car]);
+}
+
+// Функция удаления машины из карты занятости
+void removeCarFromMask(Parking& p, int car) {
+    rules::removeCar(board, p, p.cars[car]);
+}
+
+// Функция сброса карты занятости машин
+void clearCarMask(Parking& p) {
+    rules::clearCars(p);
+}
+
+// Функция проверки, свободна ли указанная клетка
+bool isCellFree(const Parking& p, int x, int y) {
+    return rules::cellFree(board, p, x, y);
+}
+
+// Функция поиска машины в клетке по индексу клеток: машина с наименьшим номером
+// (как при переборе машин по порядку), -1 - клетка пуста или вне парковки
+int carAtCell(const Parking& p, int x, int y) {
+    if (!inGrid(x, y)) return -1;
+    uint32_t cars = p.cellCars[y * GRID_WIDTH + x];
+    if (!cars) return -1;
+    // Номер младшего бита по таблице де Брёйна
+    static const int lowestBit[32] = {0,  1,  28, 2,  29, 14, 24, 3,  30, 22, 20, 15, 25, 17, 4,  8,
+                                      31, 27, 13, 23, 21, 19, 16, 7,  26, 12, 18, 6,  11, 5,  10, 9};
+    return lowestBit[((cars & (0u - cars)) * 0x077CB531u) >> 27];
+}
+
+//Функция для генерации препятствий
+void generateObstacles(Parking& p, int difficulty, ParkingRng& rng) {
+    // Количество препятствий зависит от сложности
+    int numObstacles = rules::obstacleCountFor(board, difficulty);
+    if (numObstacles > MAX_OBSTACLES) numObstacles = MAX_OBSTACLES;
+    rules::placeObstacles(board, p, numObstacles, rng);
+}
+
+//Функция для расчета формы машины
+Rect calculateCarRect(const Car& car) {
+    Rect rect;
+
+    if (car.dir == UP || car.dir == DOWN) {
+        // Вертикальные машины (2 клетки в высоту)
+        rect.x = LEFT_X + car.x * GRID_SIZE;
+        rect.y = LEFT_Y + (car.dir == DOWN ? car.y : car.y - 1) * GRID_SIZE;
+        rect.w = GRID_SIZE;
+        rect.h = 2 * GRID_SIZE; // Фиксированная длина
+    } else {
+        // Горизонтальные машины (2 клетки в ширину)
+        rect.x = LEFT_X + (car.dir == RIGHT ? car.x : car.x - 1) * GRID_SIZE;
+        rect.y = LEFT_Y + car.y * GRID_SIZE;
+        rect.w = 2 * GRID_SIZE; // Фиксированная длина
+        rect.h = GRID_SIZE;
+    }
+
+    return rect;
+}
+
+// Функция генерации случайной парковки
+void generateParking(Parking& p, int difficulty, ParkingRng& rng) {
+    p.carCount = 0;       // Сброс машин до генерации препятствий
+    clearCarMask(p);
+
+    generateObstacles(p, difficulty, rng); // Генерация препятствий
+
+    // Количество машин зависит от сложности
+    int numCars = rules::carCountFor(board, difficulty);
+    if (numCars > MAX_CARS) numCars = MAX_CARS;
+    rules::placeCars(board, p, numCars, rng);
+}
+
+// Функция расчета шага машины вперед по ее направлению
+void directionDelta(Direction dir, int* dx, int* dy) {
+    switch (dir) {
+        case UP:    *dx = 0;  *dy = -1; break;
+        case DOWN:  *dx = 0;  *dy = 1;  break;
+        case LEFT:  *dx = -1; *dy = 0;  break;
+        case RIGHT: *dx = 1;  *dy = 0;  break;
+    }
+}
+
+// Функция поворота направления на 90 градусов
+Direction turnDirection(Direction dir, bool turnLeft) {
+    if (turnLeft) {
+        // Поворот налево (против часовой стрелки)
+        switch (dir) {
+            case UP:    return LEFT;
+            case LEFT:  return DOWN;
+            case DOWN:  return RIGHT;
+            case RIGHT: return UP;
+        }
+    } else {
+        // Поворот направо (по часовой стрелке)
+        switch (dir) {
+            case UP:    return RIGHT;
+            case RIGHT: return DOWN;
+            case DOWN:  return LEFT;
+            case LEFT:  return UP;
+        }
+    }
+    return dir;
+}
+
+// Функция проверки, стоит ли машина целиком на выезде
+// (клетки вне парковки после canMove - только выезды)
+bool isCarOnExit(const Car& car) {
+    return rules::onExit(board, car);
+}
+
+// Функция проверки, может ли машина двигаться в указанном направлении
+bool canMove(const Parking& p, const Car* car, int dx, int dy) {
+    return rules::canMove(board, p, *car, dx, dy);
+}
+
+// Функция перемещения машины (возвращает false, если ход невозможен)
+bool moveCar(Parking& p, Car* car, int dx, int dy) {
+    return rules::moveCar(board, p, *car, dx, dy);
+}
+
+// Функция только для поворота машины
+void rotateCar(Parking& p, Car* car, bool turnLeft) {
+    if (!car) return;
+    rules::rotateCar(board, p, *car, turnLeft);
+}
+
+// Функция выполнения действия игрока (возвращает true, если состояние изменилось)
+bool applyCarAction(Parking& p, Car* car, CarAction action) {
+    if (!car) return false;
+    return rules::applyAction(board, p, *car, action);
+}
+
+// Функция отмены действия, выполненного applyCarAction
+void undoCarAction(Parking& p, Car* car, CarAction action) {
+    if (!car) return;
+    rules::undoAction(board, p, *car, action);
+}
+
+// Функция проверки условия победы (все машины выехали)
+bool checkWin(const Parking& p) {
+    return rules::allExited(p);
+}
@@ -0,0 +1,139 @@
+#pragma once
+// Игровая логика парковки без зависимостей от SDL (библиотека parking_core)
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "board.h"
+#include "rng.h"
+
+// Константы игры
+const int GRID_SIZE = 50;      // Размер одной клетки парковки в пикселях
+const int GRID_WIDTH = 8;      // Ширина парковки в клетках
+const int GRID_HEIGHT = 8;     // Высота парковки в клетках
+const int MAX_CARS = 20;       // Максимальное количество машин на парковке
+const int MAX_OBSTACLES = 20;  // Максимальное количество препятствий
+const int EXIT_WIDTH = 2;      // Ширина выезда с парковки в клетках
+const int LEFT_X = 200;        // Начало области парковки по х
+const int LEFT_Y = 100;        // Начало области парковки по y
+const int MINOBSTACLECOUNT = 3;  // Минимальное колличество препятствий
+
+// Геометрия игровой парковки: маска выездов и таблица клеток строятся при компиляции
+typedef Board<GRID_WIDTH, GRID_HEIGHT, EXIT_WIDTH> ParkingBoard;
+
+// Вся парковка должна помещаться в одну 64-битную маску
+static_assert(std::is_same<ParkingBoard::Mask, uint64_t>::value, "Парковка не помещается в битовую карту");
+
+// Направления движения машин (хранятся в одном байте машины)
+enum Direction : uint8_t { UP, RIGHT, DOWN, LEFT };
+
+// Действия игрока над выбранной машиной
+enum CarAction { MOVE_FORWARD, MOVE_BACKWARD, TURN_LEFT, TURN_RIGHT };
+
+// Прямоугольник в пикселях (совпадает по раскладке с SDL_Rect)
+struct Rect {
+    int x, y, w, h;
+};
+
+// Структура, описывающая машину: только то, что читают правила, решатель и генератор.
+// Прямоугольник для отрисовки считается из нее (calculateCarRect) при рисовании, а выбранную
+// машину помнит интерфейс: 20 машин укладываются в три строки кэша.
+struct Car {
+    int16_t x, y;           // Координаты головы машины (первой клетки)
+    uint8_t length;
+    Direction dir;          // Направление движения машины
+    bool exited;            // Флаг, выехала ли машина с парковки
+};
+
+static_assert(sizeof(Car) == 8, "Машина должна занимать 8 байт");
+
+struct Obstacle {
+    int x, y;           // Координаты препятствия
+    int length;         // Длина препятствия (1-5 клеток)
+    bool isHorizontal;  // true - горизонтальное, false - вертикальное
+};
+
+// Состояние парковки: машины, препятствия и битовая карта занятости
+struct Parking {
+    Car cars[MAX_CARS];                // Массив машин на парковке
+    int carCount = 0;                  // Количество машин на парковке
+    Obstacle obstacles[MAX_OBSTACLES]; // Массив препятствий
+    int obstacleCount = 0;             // Количество препятствий
+    int moves = 0;                     // Количество сделанных ходов
+
+    // Битовая карта занятости: бит (y * GRID_WIDTH + x) соответствует клетке парковки
+    uint64_t obstacleMask = 0;  // Клетки, занятые препятствиями
+    uint64_t carMask = 0;       // Клетки, занятые машинами
+    // Число машин в каждой клетке (после поворота машины могут перекрываться)
+    unsigned char carCellCount[GRID_WIDTH * GRID_HEIGHT] = {};
+    // Машины в каждой клетке для выбора мышью: бит i - машина cars[i]
+    uint32_t cellCars[GRID_WIDTH * GRID_HEIGHT] = {};
+};
+
+static_assert(MAX_CARS <= 32, "Машины клетки не помещаются в 32-битную маску");
+
+// Учет клетки машины в индексе клеток. Вызывается общими правилами вместе с изменением
+// carCellCount; у больших парковок свои списки машин по клеткам. Номер машины - ее место в
+// p.cars, поэтому car должна быть элементом p.cars, а не копией.
+inline void indexCarCell(Parking& p, const Car& car, int index, bool add) {
+    assert(&car >= p.cars && &car < p.cars + MAX_CARS && "Машина не из p.cars");
+    uint32_t bit = 1u << (&car - p.cars);
+    if (add) p.cellCars[index] |= bit;
+    else p.cellCars[index] &= ~bit;
+}
+inline void clearCarIndex(Parking& p) {
+    for (uint32_t& cars : p.cellCars) cars = 0;
+}
+
+// Клетки, занимаемые машиной
+typedef BoardFootprint<uint64_t> Footprint;
+
+// Позиции выездов с парковки (центры сторон)
+extern const Point exits[4];
+// Клетки выездов внутри парковки
+extern const uint64_t exitMask;
+
+// Функция проверки, лежит ли клетка внутри парковки
+inline bool inGrid(int x, int y) {
+    return x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT;
+}
+
+// Бит клетки в маске занятости (клетка должна быть внутри парковки)
+inline uint64_t cellBit(int x, int y) {
+    return 1ULL << (y * GRID_WIDTH + x);
+}
+
+// Функция расчета координат i-й клетки машины
+inline void carCell(const Car& car, int i, int* cx, int* cy) {
+    if (car.dir == UP || car.dir == DOWN) {
+        *cx = car.x;
+        *cy = car.y + (car.dir == DOWN ? i : -i);
+    } else {
+        *cx = car.x + (car.dir == RIGHT ? i : -i);
+        *cy = car.y;
+    }
+}
+
+bool isExitCell(int x, int y);
+Footprint carFootprint(const Car& car, int dx, int dy);
+// Добавление и удаление машины p.cars[car] в карте занятости и индексе клеток
+void addCarToMask(Parking& p, int car);
+void removeCarFromMask(Parking& p, int car);
+void clearCarMask(Parking& p);
+bool isCellFree(const Parking& p, int x, int y);
+int carAtCell(const Parking& p, int x, int y);
+
+void generateObstacles(Parking& p, int difficulty, ParkingRng& rng);
+Rect calculateCarRect(const Car& car);
+void generateParking(Parking& p, int difficulty, ParkingRng& rng);
+
+void directionDelta(Direction dir, int* dx, int* dy);
+Direction turnDirection(Direction dir, bool turnLeft);
+bool isCarOnExit(const Car& car);
+
+bool canMove(const Parking& p, const Car* car, int dx, int dy);
+bool moveCar(Parking& p, Car* car, int dx, int dy);
+void rotateCar(Parking& p, Car* car, bool turnLeft);
+bool applyCarAction(Parking& p, Car* car, CarAction action);
+void undoCarAction(Parking& p, Car* car, CarAction action);
+bool checkWin(const Parking& p);
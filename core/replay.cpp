@@ -0,0 +1,302 @@
+#include "replay.h"
+#include "level_generator.h"
+#include "lot.h"
+#include "move_journal.h"
+
+#include <string.h>
+#include <filesystem>
+
+static const char REPLAY_MAGIC[4] = {'P', 'K', 'R', 'P'};
+
+static size_t putVarint(uint32_t v, uint8_t* out) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static const uint32_t REPLAY_UNDO_CODE = 1;
+static const uint32_t REPLAY_REDO_CODE = 2;
+static const uint32_t REPLAY_MOVE_BASE = 3;
+
+// Функция упаковки действия: ноль не встречается, поэтому байт 0 отмечает конец партии
+size_t encodeReplayMove(int car, CarAction action, uint8_t* out) {
+    return putVarint((uint32_t)car * 4 + (uint32_t)action + REPLAY_MOVE_BASE, out);
+}
+
+bool ReplayWriter::open(const char* path) {
+    close();
+
+    // Поиск оборванной последней партии (игра упала до конца партии)
+    ReplayCut cut = CUT_NONE;
+    uint64_t keep = 0;   // Сколько байт файла оставить
+    bool trim = false;
+    if (FILE* in = fopen(path, "rb")) {
+        ReplayReader reader(in);
+        Replay r;
+        while (reader.next(r)) {
+            cut = r.cut;
+            keep = r.end;
+        }
+        trim = cut != CUT_NONE;
+        if (reader.partialHeader()) {
+            // Заголовок не дописан: партии нет, следующая начнется с нового заголовка
+            cut = CUT_NONE;
+            keep = reader.partialStart();
+            trim = true;
+        }
+        fclose(in);
+    }
+
+    // Обрезка до последней целой записи: недописанный ход или счетчик не должен стать ходом партии
+    if (trim) {
+        std::error_code ec;
+        std::filesystem::resize_file(path, keep, ec);
+        if (ec) return false;
+    }
+
+    f_ = fopen(path, "ab");
+    if (!f_) return false;
+
+    // Недостающие байты конца партии: признак конца, счетчик ходов 0 (если его нет) и итог,
+    // поэтому при любом обрыве партия закрывается как незавершенная
+    static const uint8_t tail[3] = {0, 0, REPLAY_UNFINISHED};
+    size_t from = 3;
+    switch (cut) {
+        case CUT_NONE:          from = 3; break;
+        case CUT_MID_MOVE:
+        case CUT_MOVES:         from = 0; break;
+        case CUT_IN_COUNT:      from = 1; break;
+        case CUT_BEFORE_RESULT: from = 2; break;
+    }
+    if (from < 3) {
+        fwrite(tail + from, 1, 3 - from, f_);
+        fflush(f_);
+    }
+    return true;
+}
+
+void ReplayWriter::close() {
+    if (!f_) return;
+    if (recording_) end(REPLAY_UNFINISHED, 0);
+    fclose(f_);
+    f_ = NULL;
+}
+
+// Функция начала партии (незаконченная предыдущая закрывается как незавершенная)
+void ReplayWriter::begin(const ReplayHeader& h) {
+    if (!f_) return;
+    if (recording_) end(REPLAY_UNFINISHED, 0);
+    uint8_t buf[REPLAY_HEADER_BYTES];
+    memcpy(buf, REPLAY_MAGIC, 4);
+    buf[4] = (uint8_t)h.version;
+    buf[5] = (uint8_t)h.board;
+    buf[6] = (uint8_t)h.difficulty;
+    buf[7] = (uint8_t)h.width;
+    buf[8] = (uint8_t)h.height;
+    for (int i = 0; i < 8; i++) buf[9 + i] = (uint8_t)(h.seed >> (8 * i));
+    for (int i = 0; i < 4; i++) buf[17 + i] = (uint8_t)(h.attempt >> (8 * i));
+    fwrite(buf, 1, sizeof(buf), f_);
+    recording_ = true;
+}
+
+// Функция записи действия (через буфер FILE, без системного вызова на каждый ход)
+void ReplayWriter::move(int car, CarAction action) {
+    if (!recording_) return;
+    uint8_t buf[5];
+    fwrite(buf, 1, encodeReplayMove(car, action, buf), f_);
+}
+
+void ReplayWriter::undo() {
+    if (!recording_) return;
+    fputc((int)REPLAY_UNDO_CODE, f_);
+}
+
+void ReplayWriter::redo() {
+    if (!recording_) return;
+    fputc((int)REPLAY_REDO_CODE, f_);
+}
+
+// Функция конца партии: счетчик ходов и итог, файл сбрасывается на диск
+void ReplayWriter::end(ReplayResult result, int moves) {
+    if (!recording_) return;
+    uint8_t buf[7] = {0};
+    size_t n = 1 + putVarint((uint32_t)moves, buf + 1);
+    buf[n++] = (uint8_t)result;
+    fwrite(buf, 1, n, f_);
+    fflush(f_);
+    recording_ = false;
+}
+
+int ReplayReader::getByte() {
+    if (pos_ == size_) {
+        size_ = fread(buf_, 1, sizeof(buf_), f_);
+        pos_ = 0;
+        if (size_ == 0) return -1;
+    }
+    offset_++;
+    return buf_[pos_++];
+}
+
+bool ReplayReader::getVarint(uint32_t* v, bool* partial) {
+    uint32_t value = 0;
+    *partial = false;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int b = getByte();
+        if (b < 0) {
+            *partial = shift > 0;
+            return false;
+        }
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Функция чтения следующей партии
+bool ReplayReader::next(Replay& r) {
+    uint8_t h[REPLAY_HEADER_BYTES];
+    uint64_t start = offset_;
+    size_t got = 0;
+    for (; got < sizeof(h); got++) {
+        int b = getByte();
+        if (b < 0) break;
+        h[got] = (uint8_t)b;
+    }
+    if (got == 0) return false; // Конец файла ровно на границе партий
+    if (got < sizeof(h) && memcmp(h, REPLAY_MAGIC, got < 4 ? got : 4) == 0) {
+        partialHeader_ = true; // Игра упала, не дописав заголовок
+        partialStart_ = start;
+        return false;
+    }
+    if (got < sizeof(h) || memcmp(h, REPLAY_MAGIC, 4) != 0 || h[4] < 1 || h[4] > REPLAY_VERSION) {
+        failed_ = true;
+        return false;
+    }
+
+    r.header.version = h[4];
+    r.header.board = h[5];
+    r.header.difficulty = h[6];
+    r.header.width = h[7];
+    r.header.height = h[8];
+    r.header.seed = 0;
+    for (int i = 0; i < 8; i++) r.header.seed |= (uint64_t)h[9 + i] << (8 * i);
+    r.header.attempt = 0;
+    for (int i = 0; i < 4; i++) r.header.attempt |= (uint32_t)h[17 + i] << (8 * i);
+    r.moves.clear();
+    r.result = REPLAY_UNFINISHED;
+    r.recordedMoves = 0;
+    r.cut = CUT_NONE;
+    r.end = offset_;
+
+    // Обрыв файла на любом месте - незавершенная партия; r.end остается после последней целой записи
+    bool partial;
+    for (;;) {
+        uint32_t v;
+        if (!getVarint(&v, &partial)) {
+            r.cut = partial ? CUT_MID_MOVE : CUT_MOVES;
+            return true;
+        }
+        if (v == 0) break;
+        r.end = offset_;
+        if (r.header.version == 1) v--;
+        else if (v == REPLAY_UNDO_CODE || v == REPLAY_REDO_CODE) {
+            r.moves.push_back({v == REPLAY_UNDO_CODE ? REPLAY_UNDO : REPLAY_REDO, MOVE_FORWARD});
+            continue;
+        }
+        else v -= REPLAY_MOVE_BASE;
+        r.moves.push_back({(int)(v >> 2), (CarAction)(v & 3)});
+    }
+
+    r.end = offset_;
+    uint32_t moves;
+    if (!getVarint(&moves, &partial)) {
+        r.cut = CUT_IN_COUNT;
+        return true;
+    }
+    r.end = offset_;
+    int result = getByte();
+    if (result < 0) {
+        r.cut = CUT_BEFORE_RESULT;
+        return true;
+    }
+    if (result != REPLAY_ABANDONED && result != REPLAY_WON && result != REPLAY_UNFINISHED) {
+        failed_ = true;
+        return false;
+    }
+    r.result = result;
+    r.recordedMoves = (int)moves;
+    return true;
+}
+
+// Функция повторной симуляции партии
+ReplayOutcome simulateReplay(const Replay& r) {
+    ReplayOutcome o;
+    ParkingRng rng;
+    seedLevelRng(rng, r.header.seed, r.header.attempt);
+    static thread_local MoveJournal journal;
+    journal.clear();
+
+    if (r.header.board == REPLAY_PARKING) {
+        if (r.header.width != GRID_WIDTH || r.header.height != GRID_HEIGHT) return o;
+        static thread_local Parking p;
+        generateParking(p, r.header.difficulty, rng);
+        for (const ReplayMove& m : r.moves) {
+            if (m.car == REPLAY_UNDO) {
+                if (!journal.canUndo()) return o;
+                JournalEntry e = journal.undo();
+                undoCarAction(p, &p.cars[e.car], e.action);
+                continue;
+            }
+            if (m.car == REPLAY_REDO) {
+                if (!journal.canRedo()) return o;
+                JournalEntry e = journal.redo();
+                applyCarAction(p, &p.cars[e.car], e.action);
+                continue;
+            }
+            if (m.car < 0 || m.car >= p.carCount) return o;
+            if (applyCarAction(p, &p.cars[m.car], m.action)) journal.record(m.car, m.action);
+        }
+        o.won = checkWin(p);
+        o.moves = p.moves;
+    } else if (r.header.board == REPLAY_LOT) {
+        std::unique_ptr<LotBase> lot = createLot(r.header.width, r.header.height);
+        if (!lot) return o;
+        lot->generate(r.header.difficulty, rng);
+        for (const ReplayMove& m : r.moves) {
+            if (m.car == REPLAY_UNDO) {
+                if (!journal.canUndo()) return o;
+                JournalEntry e = journal.undo();
+                lot->undoCarAction(e.car, e.action);
+                continue;
+            }
+            if (m.car == REPLAY_REDO) {
+                if (!journal.canRedo()) return o;
+                JournalEntry e = journal.redo();
+                lot->applyCarAction(e.car, e.action);
+                continue;
+            }
+            if (m.car < 0 || m.car >= lot->carCount()) return o;
+            if (lot->applyCarAction(m.car, m.action)) journal.record(m.car, m.action);
+        }
+        o.won = lot->checkWin();
+        o.moves = lot->moves();
+    } else {
+        return o;
+    }
+    o.valid = true;
+    return o;
+}
+
+// Функция проверки итога партии
+bool replayMatches(const Replay& r, const ReplayOutcome& o) {
+    if (!o.valid) return false;
+    if (r.result == REPLAY_UNFINISHED) return true;
+    return o.moves == r.recordedMoves && o.won == (r.result == REPLAY_WON);
+}
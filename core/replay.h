@@ -0,0 +1,121 @@
+#pragma once
+// Запись партий: зерно уровня и поток действий игрока, около одного байта на ход.
+// Партии дописываются в конец одного файла и читаются потоком, по одной.
+//
+// Формат партии (все числа little-endian):
+//   заголовок 21 байт: "PKRP", версия, вид парковки (0 - Parking 8x8, 1 - LotBase),
+//                      сложность, ширина, высота, зерно уровня (8 байт), номер кандидата (4 байта)
+//   ходы: varint(номер машины * 4 + действие + 3) - 1 байт при номере машины до 30;
+//         1 - отмена последнего хода, 2 - повтор отмененного (с версии 2; в версии 1 ходы
+//         записаны как varint(номер машины * 4 + действие + 1))
+//   конец: байт 0, varint(число ходов по счетчику игры), итог (0 - брошена, 1 - победа, 2 - не завершена)
+// Партия без конца (игра упала) читается как незавершенная; при следующем открытии файла
+// на дозапись она обрезается до последней целой записи (ход, оборванный посередине, отбрасывается)
+// и закрывается, чтобы за ней можно было писать новые. Партия, оборванная в заголовке, удаляется.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "parking.h"
+
+const int REPLAY_VERSION = 2;  // 2 - отмена и повтор ходов
+const size_t REPLAY_HEADER_BYTES = 21;
+
+enum ReplayBoard { REPLAY_PARKING = 0, REPLAY_LOT = 1 };
+enum ReplayResult { REPLAY_ABANDONED = 0, REPLAY_WON = 1, REPLAY_UNFINISHED = 2 };
+
+// Где оборвана партия без конца (для дописывания недостающих байт)
+enum ReplayCut { CUT_NONE, CUT_MOVES, CUT_MID_MOVE, CUT_IN_COUNT, CUT_BEFORE_RESULT };
+
+struct ReplayHeader {
+    int version = REPLAY_VERSION;
+    int board = REPLAY_PARKING;
+    int difficulty = 1;
+    int width = GRID_WIDTH;
+    int height = GRID_HEIGHT;
+    uint64_t seed = 0;
+    uint32_t attempt = 0;      // Уровень = seedLevelRng(seed, attempt) + генерация
+};
+
+// Особые номера машины в ReplayMove: отмена и повтор хода по журналу (MoveJournal)
+const int REPLAY_UNDO = -1;
+const int REPLAY_REDO = -2;
+
+struct ReplayMove {
+    int car;
+    CarAction action;
+};
+
+// Прочитанная партия
+struct Replay {
+    ReplayHeader header;
+    std::vector<ReplayMove> moves;
+    int result = REPLAY_UNFINISHED;
+    int recordedMoves = 0;     // Счетчик ходов игры на момент конца партии
+    ReplayCut cut = CUT_NONE;
+    uint64_t end = 0;          // Смещение в файле после последней целой записи партии
+};
+
+// Запись партий в конец файла
+class ReplayWriter {
+public:
+    ~ReplayWriter() { close(); }
+
+    bool open(const char* path);  // Файл открывается на дозапись (оборванная последняя партия закрывается)
+    void close();
+    bool isOpen() const { return f_ != NULL; }
+    bool recording() const { return recording_; }
+
+    void begin(const ReplayHeader& h);
+    void move(int car, CarAction action);
+    void undo();
+    void redo();
+    void end(ReplayResult result, int moves);
+
+private:
+    FILE* f_ = NULL;
+    bool recording_ = false;
+};
+
+// Последовательное чтение партий из файла через буфер
+class ReplayReader {
+public:
+    explicit ReplayReader(FILE* f) : f_(f) {}
+
+    // Чтение следующей партии; false - конец файла или поврежденные данные (failed())
+    bool next(Replay& r);
+    bool failed() const { return failed_; }
+    // Файл оборван в заголовке партии, начатой по смещению partialStart() (партия не читается)
+    bool partialHeader() const { return partialHeader_; }
+    uint64_t partialStart() const { return partialStart_; }
+
+private:
+    int getByte();               // -1 - конец файла
+    bool getVarint(uint32_t* v, bool* partial); // false - обрыв (partial - посреди числа)
+
+    FILE* f_;
+    uint8_t buf_[1 << 16];
+    size_t pos_ = 0, size_ = 0;
+    uint64_t offset_ = 0;        // Прочитано байт от начала файла
+    bool failed_ = false;
+    bool partialHeader_ = false;
+    uint64_t partialStart_ = 0;
+};
+
+// Итог повторной симуляции партии
+struct ReplayOutcome {
+    bool valid = false;  // Уровень восстановлен и все ходы относятся к существующим машинам
+    bool won = false;
+    int moves = 0;       // Счетчик ходов после всех действий
+};
+
+// Функция повторной симуляции партии через правила игры (applyCarAction -> moveCar/rotateCar,
+// отмена и повтор - через журнал ходов, как в игре)
+ReplayOutcome simulateReplay(const Replay& r);
+// Функция проверки итога партии: совпадают победа и число ходов (незавершенные - только восстановимость)
+bool replayMatches(const Replay& r, const ReplayOutcome& o);
+
+// Функция упаковки действия, возвращает число байт (не больше 5)
+size_t encodeReplayMove(int car, CarAction action, uint8_t* out);
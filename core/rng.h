@@ -0,0 +1,56 @@
+#pragma once
+// Генератор случайных чисел для генерации уровней: xoshiro256** (32 байта состояния,
+// несколько тактов на число). У каждого потока свой экземпляр, общего состояния нет,
+// поэтому генераторы не мешают друг другу, а уровень полностью задается зерном.
+
+#include <stdint.h>
+
+// Шаг splitmix64: из одного 64-битного числа получается хорошо перемешанная последовательность
+inline uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+class ParkingRng {
+public:
+    typedef uint64_t result_type;
+
+    ParkingRng() { seed(0); }
+    explicit ParkingRng(uint64_t value, uint64_t stream = 0) { seed(value, stream); }
+
+    // Инициализация по зерну и номеру потока последовательностей: разные (value, stream)
+    // дают независимые последовательности, одинаковые - одну и ту же
+    void seed(uint64_t value, uint64_t stream = 0) {
+        uint64_t sm = value;
+        uint64_t mixed = splitMix64(sm) ^ stream * 0xD1B54A32D192ED03ULL;
+        for (int i = 0; i < 4; i++) s_[i] = splitMix64(mixed);
+    }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    uint64_t operator()() {
+        uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4];
+};
+
+// Случайное число от 0 до n-1: старшие 32 бита умножаются на n без деления
+// (смещение не больше n / 2^32, для размеров парковки незаметно)
+inline int randomInt(ParkingRng& rng, int n) {
+    return (int)(((rng() >> 32) * (uint64_t)(uint32_t)n) >> 32);
+}
@@ -0,0 +1,504 @@
+#include "solver.h"
+
+#include <string.h>
+#include <chrono>
+#include <queue>
+
+// Состояние одной машины упаковывается в 16 бит: x и y головы со смещением, направление.
+// Голова машины всегда на парковке или на выезде, поэтому смещения в две клетки достаточно.
+static const int CODE_OFFSET = 2;
+static const int CODE_COUNT = 1024;          // 4 бита x, 4 бита y, 2 бита направления
+static const uint16_t EXITED_CODE = 0xFFFF;  // Машина выехала
+static const uint16_t INF_DIST = 0xFFFF;     // Машина не может выехать даже с пустой парковки
+static const int MAX_CAR_LENGTH = 8;
+
+static_assert(GRID_WIDTH + 2 * CODE_OFFSET <= 16 && GRID_HEIGHT + 2 * CODE_OFFSET <= 16,
+              "Координаты машины не помещаются в код состояния");
+
+// Функция упаковки состояния машины
+static uint16_t encodeCar(const Car& car) {
+    if (car.exited) return EXITED_CODE;
+    int x = car.x + CODE_OFFSET;
+    int y = car.y + CODE_OFFSET;
+    if (x < 0 || x >= 16 || y < 0 || y >= 16) return EXITED_CODE - 1; // Недостижимо по правилам игры
+    return (uint16_t)(x | (y << 4) | ((int)car.dir << 8));
+}
+
+// Функция распаковки состояния машины (длина берется из исходной машины)
+static void decodeCar(uint16_t code, Car* car) {
+    if (code == EXITED_CODE) {
+        car->exited = true;
+        return;
+    }
+    car->exited = false;
+    car->x = (code & 15) - CODE_OFFSET;
+    car->y = ((code >> 4) & 15) - CODE_OFFSET;
+    car->dir = static_cast<Direction>((code >> 8) & 3);
+}
+
+// Ключи Зобриста: машина i в состоянии code дает вклад zobrist[i][code], выехавшая - 0
+static uint64_t zobrist[MAX_CARS][CODE_COUNT];
+
+static bool fillZobrist() {
+    uint64_t s = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < MAX_CARS; i++)
+        for (int c = 0; c < CODE_COUNT; c++)
+            zobrist[i][c] = splitMix64(s); // Детерминированные ключи, одинаковые от запуска к запуску
+    return true;
+}
+
+// Таблица заполняется один раз, в том числе при вызове решателя из нескольких потоков
+static void initZobrist() {
+    static const bool ready = fillZobrist();
+    (void)ready;
+}
+
+static inline uint64_t zobristKey(int car, uint16_t code) {
+    return code < CODE_COUNT ? zobrist[car][code] : 0;
+}
+
+// Функция расчета результата действия над машиной без изменения парковки
+static bool actionResult(const Parking& p, const Car& car, CarAction action, Car* out) {
+    *out = car;
+    int dx = 0, dy = 0;
+    directionDelta(car.dir, &dx, &dy);
+    switch (action) {
+        case MOVE_BACKWARD:
+            dx = -dx;
+            dy = -dy;
+            // fallthrough
+        case MOVE_FORWARD:
+            if (!canMove(p, &car, dx, dy)) return false;
+            out->x += dx;
+            out->y += dy;
+            out->exited = isCarOnExit(*out);
+            return true;
+        case TURN_LEFT:
+        case TURN_RIGHT:
+            out->dir = turnDirection(car.dir, action == TURN_LEFT);
+            return true;
+    }
+    return false;
+}
+
+// Эвристика: число действий, за которое машина выехала бы с парковки без других машин.
+// Другие машины только мешают движению, поэтому сумма по машинам не переоценивает решение.
+static void buildExitDistances(const Parking& start, int length, uint16_t* dist) {
+    Parking empty = start;
+    empty.carCount = 0;
+    clearCarMask(empty);
+
+    // Обратные ребра графа состояний одной машины
+    std::vector<std::vector<uint16_t>> reverse(CODE_COUNT);
+    std::vector<uint16_t> queue;
+    for (int c = 0; c < CODE_COUNT; c++) dist[c] = INF_DIST;
+
+    for (int c = 0; c < CODE_COUNT; c++) {
+        Car car;
+        car.length = length;
+        decodeCar((uint16_t)c, &car);
+        for (int a = MOVE_FORWARD; a <= TURN_RIGHT; a++) {
+            Car next;
+            if (!actionResult(empty, car, (CarAction)a, &next)) continue;
+            if (next.exited) {
+                if (dist[c] != 1) {
+                    dist[c] = 1;
+                    queue.push_back((uint16_t)c);
+                }
+            } else {
+                uint16_t nc = encodeCar(next);
+                if (nc < CODE_COUNT) reverse[nc].push_back((uint16_t)c);
+            }
+        }
+    }
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        uint16_t c = queue[head];
+        for (uint16_t prev : reverse[c])
+            if (dist[prev] == INF_DIST) {
+                dist[prev] = dist[c] + 1;
+                queue.push_back(prev);
+            }
+    }
+}
+
+// Кратчайший путь одной машины до выезда при неподвижных остальных машинах (BFS по ее состояниям)
+static bool carExitPath(const Parking& p, int index, std::vector<CarAction>* path) {
+    struct Visit {
+        uint16_t prev;
+        uint8_t action;
+        bool seen;
+    };
+    static thread_local Visit visit[CODE_COUNT];
+    for (int c = 0; c < CODE_COUNT; c++) visit[c].seen = false;
+
+    const Car& car = p.cars[index];
+    uint16_t startCode = encodeCar(car);
+    if (startCode >= CODE_COUNT) return false;
+    visit[startCode].seen = true;
+
+    std::vector<uint16_t> queue(1, startCode);
+    for (size_t head = 0; head < queue.size(); head++) {
+        uint16_t c = queue[head];
+        Car cur = car;
+        decodeCar(c, &cur);
+        for (int a = MOVE_FORWARD; a <= TURN_RIGHT; a++) {
+            Car next;
+            if (!actionResult(p, cur, (CarAction)a, &next)) continue;
+            if (next.exited) {
+                // Восстановление пути от выезда к началу
+                path->clear();
+                path->push_back((CarAction)a);
+                for (uint16_t k = c; k != startCode; k = visit[k].prev)
+                    path->push_back((CarAction)visit[k].action);
+                std::vector<CarAction>(path->rbegin(), path->rend()).swap(*path);
+                return true;
+            }
+            uint16_t nc = encodeCar(next);
+            if (nc >= CODE_COUNT || visit[nc].seen) continue;
+            visit[nc] = {c, (uint8_t)a, true};
+            queue.push_back(nc);
+        }
+    }
+    return false;
+}
+
+// Верхняя оценка: машины выезжают по одной, каждая по кратчайшему пути при неподвижных остальных.
+// Если длина плана совпала с нижней оценкой, план оптимален и перебор не нужен.
+static bool sequentialPlan(const Parking& start, const uint16_t* const* dist, std::vector<SolverMove>* plan) {
+    Parking work = start;
+    std::vector<CarAction> path, best;
+    plan->clear();
+
+    for (;;) {
+        int bestCar = -1;
+        int bestExcess = 0;
+        for (int i = 0; i < work.carCount; i++) {
+            if (work.cars[i].exited) continue;
+            if (!carExitPath(work, i, &path)) continue;
+            int excess = (int)path.size() - dist[i][encodeCar(work.cars[i])];
+            if (bestCar < 0 || excess < bestExcess) {
+                bestCar = i;
+                bestExcess = excess;
+                best.swap(path);
+                if (excess == 0) break; // Лучше не бывает
+            }
+        }
+        if (bestCar < 0) return checkWin(work); // Все выехали или оставшиеся заперли друг друга
+
+        for (CarAction a : best) {
+            applyCarAction(work, &work.cars[bestCar], a);
+            plan->push_back({bestCar, a});
+        }
+    }
+}
+
+// Функция построения таблиц расстояний до выезда: dist[i] - таблица для длины машины i
+static bool buildDistTables(const Parking& start, std::vector<uint16_t>* distByLength, const uint16_t** dist) {
+    for (int i = 0; i < start.carCount; i++) {
+        int len = start.cars[i].length;
+        if (len < 1 || len > MAX_CAR_LENGTH) return false;
+        if (distByLength[len].empty()) {
+            distByLength[len].resize(CODE_COUNT);
+            buildExitDistances(start, len, distByLength[len].data());
+        }
+        dist[i] = distByLength[len].data();
+    }
+    return true;
+}
+
+namespace {
+
+struct Node {
+    uint64_t hash;    // Ключ Зобриста расстановки машин
+    uint32_t parent;
+    uint16_t g;       // Длина пути от начального состояния
+    uint16_t h;       // Оценка оставшегося пути
+    uint8_t car;      // Действие, которым пришли в узел
+    uint8_t action;
+    bool closed;
+};
+
+// Таблица "ключ Зобриста -> номер узла" с открытой адресацией
+class StateTable {
+public:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+    StateTable() : keys_(1024), values_(1024, EMPTY), size_(0) {}
+
+    // Возвращает ссылку на номер узла; для нового ключа там будет EMPTY
+    uint32_t& lookup(uint64_t key) {
+        if ((size_ + 1) * 2 > keys_.size()) grow();
+        size_t mask = keys_.size() - 1;
+        size_t i = (size_t)(key ^ (key >> 29)) & mask;
+        while (values_[i] != EMPTY && keys_[i] != key) i = (i + 1) & mask;
+        if (values_[i] == EMPTY) keys_[i] = key;
+        return values_[i];
+    }
+
+    void commit() { size_++; }  // Новый ключ получил номер узла
+    size_t size() const { return size_; }
+    size_t memoryBytes() const { return keys_.capacity() * sizeof(uint64_t) + values_.capacity() * sizeof(uint32_t); }
+
+private:
+    void grow() {
+        std::vector<uint64_t> oldKeys(keys_.size() * 2);
+        std::vector<uint32_t> oldValues(values_.size() * 2, EMPTY);
+        oldKeys.swap(keys_);
+        oldValues.swap(values_);
+        size_t mask = keys_.size() - 1;
+        for (size_t k = 0; k < oldKeys.size(); k++) {
+            if (oldValues[k] == EMPTY) continue;
+            size_t i = (size_t)(oldKeys[k] ^ (oldKeys[k] >> 29)) & mask;
+            while (values_[i] != EMPTY) i = (i + 1) & mask;
+            keys_[i] = oldKeys[k];
+            values_[i] = oldValues[k];
+        }
+    }
+
+    std::vector<uint64_t> keys_;
+    std::vector<uint32_t> values_;
+    size_t size_;
+};
+
+struct OpenEntry {
+    uint32_t f, g, node;
+    // При равной оценке сначала раскрываем более глубокие узлы
+    bool operator<(const OpenEntry& o) const {
+        return f != o.f ? f > o.f : g < o.g;
+    }
+};
+
+} // namespace
+
+uint64_t parkingStateKey(const Parking& p) {
+    initZobrist();
+    uint64_t key = 0;
+    for (int i = 0; i < p.carCount; i++) key ^= zobristKey(i, encodeCar(p.cars[i]));
+    return key;
+}
+
+SolveResult solveParking(const Parking& start, size_t nodeLimit, bool requireOptimal,
+                         const std::atomic<bool>* cancel) {
+    auto t0 = std::chrono::steady_clock::now();
+    SolveResult result;
+    initZobrist();
+
+    const int n = start.carCount;
+    Parking work = start;
+
+    // Таблицы расстояний до выезда для каждой встречающейся длины машины
+    std::vector<uint16_t> distByLength[MAX_CAR_LENGTH + 1];
+    const uint16_t* dist[MAX_CARS];
+    if (!buildDistTables(start, distByLength, dist)) {
+        result.status = SOLVE_UNSOLVABLE;
+        return result;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<uint16_t> states;  // Коды машин: узел k занимает states[k*n .. k*n + n)
+    StateTable index;
+    std::priority_queue<OpenEntry> open;
+    size_t peakOpen = 0;
+
+    // Начальный узел
+    Node root = {0, 0, 0, 0, 0, 0, false};
+    unsigned h0 = 0;
+    for (int i = 0; i < n; i++) {
+        uint16_t code = encodeCar(start.cars[i]);
+        states.push_back(code);
+        root.hash ^= zobristKey(i, code);
+        if (code == EXITED_CODE) continue;
+        uint16_t d = code < CODE_COUNT ? dist[i][code] : INF_DIST;
+        if (d == INF_DIST) {
+            // Машина заперта препятствиями: решения нет при любом порядке ходов
+            result.status = SOLVE_UNSOLVABLE;
+            result.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            return result;
+        }
+        h0 += d;
+    }
+    root.h = (uint16_t)h0;
+    result.lowerBound = (int)h0;
+
+    // Верхняя оценка: узлы с f не меньше нее можно не рассматривать
+    std::vector<SolverMove> upperPlan;
+    size_t upperBound = SIZE_MAX;
+    if (sequentialPlan(start, dist, &upperPlan)) {
+        upperBound = upperPlan.size();
+        if (upperBound == h0 || !requireOptimal) {
+            result.status = SOLVE_FOUND;
+            result.optimal = upperBound == h0;
+            result.moves.swap(upperPlan);
+            result.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            return result;
+        }
+    }
+
+    nodes.push_back(root);
+    index.lookup(root.hash) = 0;
+    index.commit();
+    open.push({root.h, 0, 0});
+
+    uint16_t parentState[MAX_CARS];
+    result.status = SOLVE_UNSOLVABLE;
+    int64_t goal = -1;
+
+    while (!open.empty()) {
+        OpenEntry top = open.top();
+        open.pop();
+        // Эвристика согласованная, поэтому оценки раскрываемых узлов не убывают
+        if ((int)top.f > result.lowerBound) result.lowerBound = (int)top.f;
+        Node& cur = nodes[top.node];
+        if (cur.closed || top.g != cur.g) continue; // Устаревшая запись очереди
+        cur.closed = true;
+        result.stats.expanded++;
+
+        // Флаг отмены проверяется раз в 256 узлов
+        if (cancel && (result.stats.expanded & 255) == 0 && cancel->load(std::memory_order_relaxed)) {
+            result.status = SOLVE_CANCELLED;
+            break;
+        }
+
+        if (cur.h == 0) {
+            goal = top.node;
+            break;
+        }
+
+        // Перенос состояния узла в рабочую парковку
+        memcpy(parentState, &states[(size_t)top.node * n], n * sizeof(uint16_t));
+        clearCarMask(work);
+        for (int i = 0; i < n; i++) {
+            decodeCar(parentState[i], &work.cars[i]);
+            if (!work.cars[i].exited) addCarToMask(work, i);
+        }
+
+        const uint64_t parentHash = cur.hash;
+        const uint16_t parentG = cur.g;
+        const uint16_t parentH = cur.h;
+        const uint32_t parentIndex = top.node;
+
+        for (int i = 0; i < n; i++) {
+            if (work.cars[i].exited) continue;
+            uint16_t oldCode = parentState[i];
+            for (int a = MOVE_FORWARD; a <= TURN_RIGHT; a++) {
+                Car next;
+                if (!actionResult(work, work.cars[i], (CarAction)a, &next)) continue;
+                uint16_t newCode = encodeCar(next);
+                uint16_t d = newCode == EXITED_CODE ? 0 : (newCode < CODE_COUNT ? dist[i][newCode] : INF_DIST);
+                if (d == INF_DIST) continue; // Из этого положения машина уже не выедет
+                result.stats.generated++;
+
+                uint64_t hash = parentHash ^ zobristKey(i, oldCode) ^ zobristKey(i, newCode);
+                uint16_t g = parentG + 1;
+                uint16_t h = parentH - dist[i][oldCode] + d;
+                if ((size_t)g + h >= upperBound) continue; // Не лучше уже известного плана
+
+                uint32_t& slot = index.lookup(hash);
+                if (slot != StateTable::EMPTY) {
+                    Node& known = nodes[slot];
+                    if (known.closed || known.g <= g) continue;
+                    known.g = g;
+                    known.parent = parentIndex;
+                    known.car = (uint8_t)i;
+                    known.action = (uint8_t)a;
+                    open.push({(uint32_t)g + known.h, g, slot});
+                    continue;
+                }
+
+                if (index.size() >= nodeLimit) {
+                    result.status = SOLVE_LIMIT;
+                    open = std::priority_queue<OpenEntry>();
+                    break;
+                }
+
+                uint32_t k = (uint32_t)nodes.size();
+                Node child = {hash, parentIndex, g, h, (uint8_t)i, (uint8_t)a, false};
+                nodes.push_back(child);
+                states.insert(states.end(), parentState, parentState + n);
+                states[(size_t)k * n + i] = newCode;
+                slot = k;
+                index.commit();
+                open.push({(uint32_t)g + h, g, k});
+            }
+            if (result.status == SOLVE_LIMIT) break;
+        }
+        if (result.status == SOLVE_LIMIT) break;
+        if (open.size() > peakOpen) peakOpen = open.size();
+    }
+
+    if (goal >= 0) {
+        result.status = SOLVE_FOUND;
+        result.optimal = true;
+        for (uint32_t k = (uint32_t)goal; k != 0; k = nodes[k].parent)
+            result.moves.push_back({nodes[k].car, (CarAction)nodes[k].action});
+        std::vector<SolverMove>(result.moves.rbegin(), result.moves.rend()).swap(result.moves);
+    } else if (result.status == SOLVE_CANCELLED) {
+        // Незаконченный поиск ничего не доказал
+    } else if (!upperPlan.empty()) {
+        // Лучше плана по одной машине нет (перебор исчерпан) или доказать это не хватило лимита
+        result.optimal = result.status != SOLVE_LIMIT;
+        result.status = SOLVE_FOUND;
+        result.moves.swap(upperPlan);
+    }
+    if (result.optimal) result.lowerBound = (int)result.moves.size();
+
+    result.stats.stored = index.size();
+    result.stats.memoryBytes = nodes.capacity() * sizeof(Node)
+                             + states.capacity() * sizeof(uint16_t)
+                             + index.memoryBytes()
+                             + peakOpen * sizeof(OpenEntry);
+    result.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
+
+// Функция оценки сложности: решение и разбор всех возможных действий в каждом положении на его пути.
+// Действие - тупик, если после него нижняя оценка (сумма расстояний машин до выезда без помех)
+// больше оставшейся длины решения: по такому ходу решение той же длины уже не получить.
+DifficultyMetrics measureDifficulty(const Parking& start, size_t nodeLimit, const std::atomic<bool>* cancel) {
+    DifficultyMetrics m;
+    SolveResult r = solveParking(start, nodeLimit, true, cancel);
+    m.status = r.status;
+    m.stats = r.stats;
+    if (r.status != SOLVE_FOUND) return m;
+    m.optimal = r.optimal;
+    m.optimalMoves = (int)r.moves.size();
+    m.lowerBound = r.lowerBound;
+
+    std::vector<uint16_t> distByLength[MAX_CAR_LENGTH + 1];
+    const uint16_t* dist[MAX_CARS];
+    if (!buildDistTables(start, distByLength, dist)) return m;
+
+    Parking work = start;
+    for (int i = 0; i < work.carCount; i++)
+        if (!work.cars[i].exited) m.freeMoves += dist[i][encodeCar(work.cars[i])];
+    m.blockingMoves = m.optimalMoves - m.freeMoves;
+
+    uint64_t choices = 0, deadEnds = 0;
+    for (int step = 0; step < m.optimalMoves; step++) {
+        int remaining = m.optimalMoves - step;
+        int bound = 0;
+        for (int i = 0; i < work.carCount; i++)
+            if (!work.cars[i].exited) bound += dist[i][encodeCar(work.cars[i])];
+
+        for (int i = 0; i < work.carCount; i++) {
+            if (work.cars[i].exited) continue;
+            uint16_t before = dist[i][encodeCar(work.cars[i])];
+            for (int a = MOVE_FORWARD; a <= TURN_RIGHT; a++) {
+                Car next;
+                if (!actionResult(work, work.cars[i], (CarAction)a, &next)) continue;
+                choices++;
+                uint16_t code = encodeCar(next);
+                int after = code == EXITED_CODE ? 0 : (code < CODE_COUNT ? dist[i][code] : INF_DIST);
+                if (after == INF_DIST || bound - before + after > remaining - 1) deadEnds++;
+            }
+        }
+        const SolverMove& move = r.moves[step];
+        applyCarAction(work, &work.cars[move.car], move.action);
+    }
+    if (choices) {
+        m.branchingFactor = (double)choices / m.optimalMoves;
+        m.deadEndRatio = (double)deadEnds / choices;
+    }
+    return m;
+}
@@ -0,0 +1,68 @@
+#pragma once
+// Поиск кратчайшего решения парковки (A* с хешированием состояний по Зобристу)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include "parking.h"
+
+// Один ход решения: номер машины в Parking::cars и действие над ней
+struct SolverMove {
+    int car;
+    CarAction action;
+};
+
+// Итог поиска
+enum SolveStatus {
+    SOLVE_FOUND,       // Решение найдено (при нехватке лимита - лучшее известное, optimal = false)
+    SOLVE_UNSOLVABLE,  // Все достижимые состояния перебраны, решения нет
+    SOLVE_LIMIT,       // Превышен лимит узлов, решение не найдено
+    SOLVE_CANCELLED    // Поиск остановлен флагом отмены
+};
+
+// Статистика поиска для отслеживания производительности решателя
+struct SolveStats {
+    uint64_t expanded = 0;    // Раскрыто узлов
+    uint64_t generated = 0;   // Сгенерировано потомков (с повторами)
+    uint64_t stored = 0;      // Уникальных состояний в таблице
+    size_t memoryBytes = 0;   // Оценка памяти под узлы, таблицу и очередь
+    double seconds = 0;       // Время поиска
+};
+
+struct SolveResult {
+    SolveStatus status = SOLVE_UNSOLVABLE;
+    bool optimal = false;           // Длина решения доказанно минимальна
+    int lowerBound = 0;             // Доказано, что решения короче нет (при optimal - длина решения)
+    std::vector<SolverMove> moves;  // Кратчайшая последовательность действий
+    SolveStats stats;
+};
+
+const size_t DEFAULT_SOLVER_NODE_LIMIT = 500000; // Лимит уникальных состояний по умолчанию (~40 МБ)
+
+// Поиск минимальной последовательности moveCar/rotateCar, после которой все машины выехали.
+// При requireOptimal = false возвращается первое найденное решение (для проверки решаемости).
+// Если cancel стал true, поиск прекращается за единицы миллисекунд (SOLVE_CANCELLED).
+SolveResult solveParking(const Parking& start, size_t nodeLimit = DEFAULT_SOLVER_NODE_LIMIT,
+                         bool requireOptimal = true, const std::atomic<bool>* cancel = nullptr);
+
+// Метрики сложности парковки по ее решению
+struct DifficultyMetrics {
+    SolveStatus status = SOLVE_UNSOLVABLE;
+    bool optimal = false;         // optimalMoves доказанно минимально (иначе - лучшее найденное)
+    int optimalMoves = 0;         // Длина решения
+    int lowerBound = 0;           // Доказанная нижняя оценка длины (равна optimalMoves при optimal)
+    int freeMoves = 0;            // Сумма путей машин до выезда без помех (нижняя оценка длины)
+    int blockingMoves = 0;        // optimalMoves - freeMoves: ходы, чтобы машины пропустили друг друга
+    double branchingFactor = 0;   // Среднее число возможных действий в положениях на пути решения
+    double deadEndRatio = 0;      // Доля этих действий, после которых решение той же длины невозможно
+    SolveStats stats;
+};
+
+// Функция оценки сложности парковки решателем
+DifficultyMetrics measureDifficulty(const Parking& start, size_t nodeLimit = DEFAULT_SOLVER_NODE_LIMIT,
+                                    const std::atomic<bool>* cancel = nullptr);
+
+// Ключ Зобриста расстановки машин (как у узлов решателя): одинаковые расстановки - один ключ
+uint64_t parkingStateKey(const Parking& p);
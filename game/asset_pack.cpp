@@ -0,0 +1,159 @@
+#include "asset_pack.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char ASSET_PACK_MAGIC[4] = {'P', 'K', 'A', 'S'};
+
+static size_t alignUp(size_t n) {
+    return (n + ASSET_PACK_ALIGN - 1) / ASSET_PACK_ALIGN * ASSET_PACK_ALIGN;
+}
+
+bool writeAssetPack(const char* path, uint32_t format, const std::vector<AssetImage>& images) {
+    AssetPackHeader header;
+    memcpy(header.magic, ASSET_PACK_MAGIC, 4);
+    header.version = ASSET_PACK_VERSION;
+    header.format = format;
+    header.count = (uint32_t)images.size();
+
+    // Раскладка: заголовок, записи, пиксели с выравниванием
+    std::vector<AssetEntry> entries(images.size());
+    size_t offset = alignUp(sizeof(header) + entries.size() * sizeof(AssetEntry));
+    for (size_t i = 0; i < images.size(); i++) {
+        const AssetImage& img = images[i];
+        if (img.surface->format->format != format || strlen(img.name) >= sizeof(entries[i].name)) return false;
+        AssetEntry& e = entries[i];
+        memset(&e, 0, sizeof(e));
+        strcpy(e.name, img.name);
+        e.w = img.surface->w;
+        e.h = img.surface->h;
+        e.pitch = e.w * SDL_BYTESPERPIXEL(format); // Строки без хвостов поверхности
+        e.flags = img.flags;
+        e.sourceW = img.sourceW;
+        e.sourceH = img.sourceH;
+        e.offset = offset;
+        offset = alignUp(offset + (size_t)e.pitch * e.h);
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              (entries.empty() || fwrite(entries.data(), sizeof(AssetEntry), entries.size(), f) == entries.size());
+    static const uint8_t zeros[ASSET_PACK_ALIGN] = {};
+    for (size_t i = 0; ok && i < images.size(); i++) {
+        long at = ftell(f);
+        ok = at >= 0 && fwrite(zeros, 1, entries[i].offset - (size_t)at, f) == entries[i].offset - (size_t)at;
+        SDL_Surface* s = images[i].surface;
+        SDL_LockSurface(s);
+        for (int y = 0; ok && y < s->h; y++)
+            ok = fwrite((const uint8_t*)s->pixels + (size_t)y * s->pitch, entries[i].pitch, 1, f) == 1;
+        SDL_UnlockSurface(s);
+    }
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+bool AssetPack::open(const char* path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false; // Пакета нет - тихо переходим к исходным изображениям
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            data_ = (const uint8_t*)p;
+            size_ = (size_t)st.st_size;
+        }
+    }
+    ::close(fd); // Отображение остается действительным и после закрытия файла
+#else
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) buffer_.insert(buffer_.end(), chunk, chunk + n);
+    fclose(f);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+    if (!data_ || size_ < sizeof(header_)) {
+        printf("Не удалось прочитать пакет текстур %s\n", path);
+        close();
+        return false;
+    }
+
+    memcpy(&header_, data_, sizeof(header_));
+    if (memcmp(header_.magic, ASSET_PACK_MAGIC, 4) != 0 || header_.version != ASSET_PACK_VERSION) {
+        printf("Пакет текстур %s другой версии, нужна пересборка\n", path);
+        close();
+        return false;
+    }
+    // Все изображения должны целиком лежать в файле
+    bool valid = sizeof(header_) + (size_t)header_.count * sizeof(AssetEntry) <= size_;
+    for (uint32_t i = 0; valid && i < header_.count; i++) {
+        AssetEntry e;
+        memcpy(&e, data_ + sizeof(header_) + i * sizeof(AssetEntry), sizeof(e));
+        valid = e.w > 0 && e.h > 0 && e.pitch >= e.w * (int)SDL_BYTESPERPIXEL(header_.format) &&
+                e.offset <= size_ && (uint64_t)e.pitch * e.h <= size_ - e.offset;
+    }
+    if (!valid) {
+        printf("Пакет текстур %s поврежден\n", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::close() {
+#ifndef _WIN32
+    if (data_) munmap((void*)data_, size_);
+#endif
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    data_ = NULL;
+    size_ = 0;
+    header_ = AssetPackHeader();
+}
+
+bool AssetPack::supports(SDL_Renderer* renderer) const {
+    SDL_RendererInfo info;
+    if (!data_ || SDL_GetRendererInfo(renderer, &info) != 0) return false;
+    for (Uint32 i = 0; i < info.num_texture_formats; i++)
+        if (info.texture_formats[i] == header_.format) return true;
+    return false;
+}
+
+const AssetEntry* AssetPack::find(const char* name) const {
+    if (!data_) return NULL;
+    const AssetEntry* entries = (const AssetEntry*)(data_ + sizeof(header_)); // Выровнено: mmap с границы страницы
+    for (uint32_t i = 0; i < header_.count; i++)
+        if (strncmp(entries[i].name, name, sizeof(entries[i].name)) == 0) return &entries[i];
+    return NULL;
+}
+
+SDL_Texture* AssetPack::createTexture(SDL_Renderer* renderer, const char* name) const {
+    const AssetEntry* e = find(name);
+    if (!e) {
+        printf("В пакете текстур нет изображения %s\n", name);
+        return NULL;
+    }
+    SDL_Texture* texture = SDL_CreateTexture(renderer, header_.format, SDL_TEXTUREACCESS_STATIC, e->w, e->h);
+    if (texture && SDL_UpdateTexture(texture, NULL, data_ + e->offset, e->pitch) != 0) {
+        SDL_DestroyTexture(texture);
+        texture = NULL;
+    }
+    if (!texture) {
+        printf("Не удалось создать текстуру %s из пакета! Ошибка: %s\n", name, SDL_GetError());
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(texture, (e->flags & ASSET_BLEND) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+    return texture;
+}
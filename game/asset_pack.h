@@ -0,0 +1,72 @@
+#pragma once
+// Пакет текстур для быстрого запуска (assets.pack). Изображения в нем уже распакованы из PNG/JPEG
+// и переведены в формат пикселей рендерера, атлас машины уже развернут по направлениям, поэтому при
+// запуске файл отображается в память (mmap) и пиксели сразу передаются в SDL_UpdateTexture.
+// Пакет собирает утилита parking_assets при сборке игры. Если его нет, версия или формат не
+// подходят рендереру, игра загружает исходные изображения из assets/.
+//
+// Формат (числа в порядке байт машины, на которой собран пакет):
+//   заголовок 16 байт: "PKAS", версия, формат пикселей (SDL_PIXELFORMAT_*), число изображений
+//   записи по 64 байта: имя (32 байта, с нулем), ширина, высота, шаг строки в байтах, флаги,
+//                       ширина и высота исходного изображения, смещение пикселей от начала файла
+//   пиксели изображений, каждое с границы ASSET_PACK_ALIGN байт
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+const uint32_t ASSET_PACK_VERSION = 1;
+const size_t ASSET_PACK_ALIGN = 64;
+const uint32_t ASSET_BLEND = 1;  // Текстура с прозрачностью (SDL_BLENDMODE_BLEND)
+
+struct AssetPackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t count;
+};
+
+struct AssetEntry {
+    char name[32];
+    int32_t w, h, pitch;
+    uint32_t flags;
+    int32_t sourceW, sourceH;  // Размер исходного изображения (для атласа машины - самой машины)
+    uint64_t offset;
+};
+
+static_assert(sizeof(AssetPackHeader) == 16 && sizeof(AssetEntry) == 64, "Раскладка пакета изменилась");
+
+// Изображение для записи: поверхность уже в формате пакета
+struct AssetImage {
+    const char* name;
+    SDL_Surface* surface;
+    uint32_t flags;
+    int sourceW, sourceH;
+};
+
+// Функция записи пакета (false - ошибка записи или поверхность в другом формате)
+bool writeAssetPack(const char* path, uint32_t format, const std::vector<AssetImage>& images);
+
+// Пакет, отображенный в память только на время загрузки текстур
+class AssetPack {
+public:
+    ~AssetPack() { close(); }
+
+    // false - файла нет, он поврежден или другой версии (причина печатается)
+    bool open(const char* path);
+    void close();
+
+    uint32_t format() const { return header_.format; }
+    // Рендерер создает текстуры в формате пакета
+    bool supports(SDL_Renderer* renderer) const;
+    const AssetEntry* find(const char* name) const;
+    // Текстура из пикселей пакета без преобразования (NULL - нет такого изображения или ошибка SDL)
+    SDL_Texture* createTexture(SDL_Renderer* renderer, const char* name) const;
+
+private:
+    const uint8_t* data_ = NULL;
+    size_t size_ = 0;
+    AssetPackHeader header_ = {};
+    std::vector<uint8_t> buffer_;  // Содержимое файла там, где нет mmap
+};
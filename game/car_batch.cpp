@@ -0,0 +1,147 @@
+#include "car_batch.h"
+#include "draw_stats.h"
+
+#include <stdio.h>
+
+const int SHEET_PADDING = 2;  // Зазор между кадрами против просачивания соседей при фильтрации
+const int WHITE_SIZE = 4;     // Сторона белого квадрата
+
+// Функция копирования изображения с поворотом на dir четвертей оборота по часовой стрелке
+// (обе поверхности RGBA32 и заблокированы)
+static void copyRotated(const SDL_Surface* src, SDL_Surface* dst, const SDL_Rect& at, Direction dir) {
+    int w = src->w, h = src->h;
+    for (int y = 0; y < h; y++) {
+        const Uint32* row = (const Uint32*)((const Uint8*)src->pixels + y * src->pitch);
+        for (int x = 0; x < w; x++) {
+            int dx = x, dy = y;
+            switch (dir) {
+                case UP:    break;
+                case RIGHT: dx = h - 1 - y; dy = x; break;         // Верх изображения уходит направо
+                case DOWN:  dx = w - 1 - x; dy = h - 1 - y; break;
+                case LEFT:  dx = y; dy = w - 1 - x; break;         // Верх изображения уходит налево
+            }
+            Uint32* out = (Uint32*)((Uint8*)dst->pixels + (at.y + dy) * dst->pitch) + at.x + dx;
+            *out = row[x];
+        }
+    }
+}
+
+// Функция раскладки атласа: четыре кадра машины в клетках 2x2 и белый квадрат справа
+void layoutCarSheet(CarSheet& sheet, int carW, int carH) {
+    int cell = (carW > carH ? carW : carH) + SHEET_PADDING;
+    for (int d = 0; d < 4; d++) {
+        bool turned = d == RIGHT || d == LEFT; // Ширина и высота кадра меняются местами
+        sheet.frames[d] = {(d % 2) * cell, (d / 2) * cell, turned ? carH : carW, turned ? carW : carH};
+    }
+    sheet.white = {2 * cell, 0, WHITE_SIZE, WHITE_SIZE};
+    sheet.textureW = sheet.white.x + WHITE_SIZE;
+    sheet.textureH = 2 * cell - SHEET_PADDING;
+}
+
+SDL_Surface* buildCarSheetSurface(const CarSheet& sheet, SDL_Surface* car) {
+    // Изображение приводится к RGBA32, чтобы поворачивать его попиксельно
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(car, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, sheet.textureW, sheet.textureH, 32, SDL_PIXELFORMAT_RGBA32);
+    if (rgba && surface) {
+        SDL_LockSurface(rgba);
+        SDL_LockSurface(surface);
+        for (int d = 0; d < 4; d++) copyRotated(rgba, surface, sheet.frames[d], (Direction)d);
+        SDL_UnlockSurface(surface);
+        SDL_UnlockSurface(rgba);
+        SDL_FillRect(surface, &sheet.white, SDL_MapRGBA(surface->format, 255, 255, 255, 255));
+    } else if (surface) {
+        SDL_FreeSurface(surface);
+        surface = NULL;
+    }
+    if (rgba) SDL_FreeSurface(rgba);
+    return surface;
+}
+
+bool createCarSheet(CarSheet& sheet, SDL_Renderer* renderer, SDL_Surface* car) {
+    layoutCarSheet(sheet, car->w, car->h);
+    SDL_Surface* surface = buildCarSheetSurface(sheet, car);
+    if (surface) {
+        sheet.texture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_FreeSurface(surface);
+    }
+    if (!surface || !sheet.texture) {
+        printf("Не удалось создать атлас машины! Ошибка: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(sheet.texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+void destroyCarSheet(CarSheet& sheet) {
+    if (sheet.texture) SDL_DestroyTexture(sheet.texture);
+    sheet.texture = NULL;
+}
+
+void carBatchClear(CarBatch& batch) {
+    batch.vertices.clear();
+    batch.indices.clear();
+}
+
+// Функция добавления четырехугольника: углы по часовой стрелке от левого верхнего
+static void addQuad(CarBatch& batch, const SDL_FRect& r, SDL_Color color, const SDL_FPoint uv[4]) {
+    int base = (int)batch.vertices.size();
+    batch.vertices.push_back({{r.x, r.y}, color, uv[0]});
+    batch.vertices.push_back({{r.x + r.w, r.y}, color, uv[1]});
+    batch.vertices.push_back({{r.x + r.w, r.y + r.h}, color, uv[2]});
+    batch.vertices.push_back({{r.x, r.y + r.h}, color, uv[3]});
+    const int quad[6] = {0, 1, 2, 0, 2, 3};
+    for (int k = 0; k < 6; k++) batch.indices.push_back(base + quad[k]);
+}
+
+void drawCar(SDL_Renderer* renderer, const CarSheet& sheet, const SDL_Rect& rect, Direction dir) {
+    countDrawCall(SDL_RenderCopy(renderer, sheet.texture, &sheet.frames[dir], &rect));
+}
+
+// Функция добавления машины: кадр нужного направления без поворота
+void carBatchAddCar(CarBatch& batch, const CarSheet& sheet, const SDL_Rect& rect, Direction dir) {
+    const SDL_Rect& f = sheet.frames[dir];
+    float tw = (float)sheet.textureW, th = (float)sheet.textureH;
+    float u0 = f.x / tw, v0 = f.y / th;
+    float u1 = (f.x + f.w) / tw, v1 = (f.y + f.h) / th;
+    const SDL_FPoint uv[4] = {{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+
+    SDL_FRect r = {(float)rect.x, (float)rect.y, (float)rect.w, (float)rect.h};
+    SDL_Color white = {255, 255, 255, 255};
+    addQuad(batch, r, white, uv);
+}
+
+// Функция расчета координат центра белого квадрата (все вершины заливки берут его цвет)
+static SDL_FPoint whiteCenter(const CarSheet& sheet) {
+    return {(sheet.white.x + sheet.white.w * 0.5f) / sheet.textureW,
+            (sheet.white.y + sheet.white.h * 0.5f) / sheet.textureH};
+}
+
+// Функция добавления рамки: четыре полоски из центра белого квадрата
+void carBatchAddFrame(CarBatch& batch, const CarSheet& sheet, const SDL_Rect& rect, SDL_Color color) {
+    if (rect.w <= 0 || rect.h <= 0) return;
+    SDL_FPoint c = whiteCenter(sheet);
+    const SDL_FPoint uv[4] = {c, c, c, c};
+    float x = (float)rect.x, y = (float)rect.y, w = (float)rect.w, h = (float)rect.h;
+    const SDL_FRect sides[4] = {
+        {x, y, w, 1},                 // Верх
+        {x, y + h - 1, w, 1},         // Низ
+        {x, y + 1, 1, h - 2},         // Лево
+        {x + w - 1, y + 1, 1, h - 2}  // Право
+    };
+    for (int i = 0; i < 4; i++)
+        if (sides[i].w > 0 && sides[i].h > 0) addQuad(batch, sides[i], color, uv);
+}
+
+void carBatchAddRect(CarBatch& batch, const CarSheet& sheet, const SDL_Rect& rect, SDL_Color color) {
+    if (rect.w <= 0 || rect.h <= 0) return;
+    SDL_FPoint c = whiteCenter(sheet);
+    const SDL_FPoint uv[4] = {c, c, c, c};
+    SDL_FRect r = {(float)rect.x, (float)rect.y, (float)rect.w, (float)rect.h};
+    addQuad(batch, r, color, uv);
+}
+
+void carBatchDraw(CarBatch& batch, SDL_Renderer* renderer, const CarSheet& sheet) {
+    if (batch.vertices.empty()) return;
+    countDrawCall(SDL_RenderGeometry(renderer, sheet.texture, batch.vertices.data(), (int)batch.vertices.size(),
+                                     batch.indices.data(), (int)batch.indices.size()));
+}
@@ -0,0 +1,48 @@
+#pragma once
+// Отрисовка машин из атласа: при загрузке assets/car.png разворачивается в четыре кадра, по
+// одному на Direction, поэтому машина рисуется простым копированием кадра в клетки машины без
+// поворота. Пакетная отрисовка собирает все машины кадра в один буфер вершин и индексов и рисует
+// их одним вызовом SDL_RenderGeometry. Рамки выделения и подсказки - полоски из белого квадрата
+// атласа, окрашенные цветом вершин, и попадают в тот же вызов; так же, заливкой из белого
+// квадрата, LotView рисует парковку, препятствия и разметку.
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+#include "parking.h"
+
+// Атлас машины: кадры, повернутые под каждое направление, и белый квадрат для рамок
+struct CarSheet {
+    SDL_Texture* texture = NULL;
+    int textureW = 0, textureH = 0;
+    SDL_Rect frames[4];             // Кадр машины носом в сторону Direction
+    SDL_Rect white = {0, 0, 0, 0};  // Белый квадрат (берется его центр)
+};
+
+// car - изображение машины носом вверх
+bool createCarSheet(CarSheet& sheet, SDL_Renderer* renderer, SDL_Surface* car);
+// Раскладка кадров под изображение машины carW x carH (без текстуры)
+void layoutCarSheet(CarSheet& sheet, int carW, int carH);
+// Поверхность атласа RGBA32 по раскладке sheet (NULL - ошибка), освобождает вызывающий.
+// Ее же заранее кладет в пакет ресурсов parking_assets.
+SDL_Surface* buildCarSheetSurface(const CarSheet& sheet, SDL_Surface* car);
+void destroyCarSheet(CarSheet& sheet);
+
+// Отрисовка одной машины отдельным вызовом (без пакета)
+void drawCar(SDL_Renderer* renderer, const CarSheet& sheet, const SDL_Rect& rect, Direction dir);
+
+// Буфер машин одного кадра (память переиспользуется между кадрами)
+struct CarBatch {
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+void carBatchClear(CarBatch& batch);
+// Машина, занимающая прямоугольник rect, носом в сторону dir
+void carBatchAddCar(CarBatch& batch, const CarSheet& sheet, const SDL_Rect& rect, Direction dir);
+// Рамка в один пиксель по краю rect (как SDL_RenderDrawRect)
+void carBatchAddFrame(CarBatch& batch, const CarSheet& sheet, const SDL_Rect& rect, SDL_Color color);
+// Прямоугольник, залитый цветом color (как SDL_RenderFillRect)
+void carBatchAddRect(CarBatch& batch, const CarSheet& sheet, const SDL_Rect& rect, SDL_Color color);
+// Отрисовка всего буфера одним вызовом (пустой буфер не рисуется)
+void carBatchDraw(CarBatch& batch, SDL_Renderer* renderer, const CarSheet& sheet);
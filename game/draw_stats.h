@@ -0,0 +1,10 @@
+#pragma once
+// Подсчет вызовов отрисовки SDL за кадр
+
+inline int drawCallCount = 0;  // Вызовов отрисовки с начала текущего кадра
+
+// Функция учета одного вызова отрисовки (код возврата SDL передается без изменений)
+inline int countDrawCall(int rc) {
+    drawCallCount++;
+    return rc;
+}
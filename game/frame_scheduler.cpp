@@ -0,0 +1,83 @@
+#include "frame_scheduler.h"
+
+#include <thread>
+
+// Последнюю часть сна поток крутится с yield: sleep_for просыпается с опозданием
+// (на Windows - до длительности системного тика), и кадр бы уезжал за свой срок
+static const std::chrono::microseconds SPIN_MARGIN(1000);
+
+const char* pacingModeName(PacingMode mode) {
+    switch (mode) {
+        case PACING_VSYNC:      return "vsync";
+        case PACING_TARGET_FPS: return "fps";
+        case PACING_UNCAPPED:   return "uncapped";
+    }
+    return "?";
+}
+
+void FrameScheduler::configure(PacingMode mode, double fps, double updateHz) {
+    mode_ = mode;
+    fps_ = fps > 0 ? fps : 60;
+    step_ = 1 / (updateHz > 0 ? updateHz : DEFAULT_UPDATE_HZ);
+    period_ = mode == PACING_UNCAPPED ? Clock::duration::zero()
+                                      : std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / fps_));
+    accumulator_ = 0;
+    resume();
+}
+
+void FrameScheduler::resume() {
+    Clock::time_point now = Clock::now();
+    lastUpdate_ = frameStart_ = nextFrame_ = now; // Первый кадр после простоя рисуется без сна
+}
+
+// Функция пополнения накопителя: шаги обновления покрывают прошедшее время целиком
+int FrameScheduler::beginFrame() {
+    Clock::time_point now = Clock::now();
+    accumulator_ += std::chrono::duration<double>(now - lastUpdate_).count();
+    lastUpdate_ = now;
+
+    int steps = (int)(accumulator_ / step_);
+    accumulator_ -= steps * step_;
+    if (steps > MAX_UPDATES_PER_FRAME) {
+        dropped_ += steps - MAX_UPDATES_PER_FRAME; // Игра замедляется, но не застревает в догонялках
+        steps = MAX_UPDATES_PER_FRAME;
+    }
+    updates_ += steps;
+    return steps;
+}
+
+void FrameScheduler::sleepUntil(Clock::time_point deadline) {
+    for (;;) {
+        Clock::duration remaining = deadline - Clock::now();
+        if (remaining <= Clock::duration::zero()) return;
+        if (remaining > SPIN_MARGIN) std::this_thread::sleep_for(remaining - SPIN_MARGIN);
+        else std::this_thread::yield();
+    }
+}
+
+// Функция сна после кадра: спим только то, что осталось от бюджета кадра
+double FrameScheduler::endFrame() {
+    Clock::time_point now = Clock::now();
+    Clock::time_point wake = now;
+    switch (mode_) {
+        case PACING_VSYNC:
+            // SDL_RenderPresent не ждал экрана (окно свернуто или драйвер игнорирует vsync):
+            // без сна цикл крутился бы впустую
+            if (now - frameStart_ < period_ / 2) wake = frameStart_ + period_;
+            break;
+        case PACING_TARGET_FPS:
+            if (now < nextFrame_) {
+                wake = nextFrame_;
+                nextFrame_ += period_;
+            } else {
+                // Небольшое опоздание сохраняет сетку кадров, после долгого кадра сетка сдвигается
+                nextFrame_ = now - nextFrame_ > period_ ? now + period_ : nextFrame_ + period_;
+            }
+            break;
+        case PACING_UNCAPPED:
+            break;
+    }
+    if (wake > now) sleepUntil(wake);
+    frameStart_ = Clock::now();
+    return std::chrono::duration<double, std::micro>(frameStart_ - now).count();
+}
@@ -0,0 +1,54 @@
+#pragma once
+// Планировщик кадров: обновление игры идет с фиксированным шагом независимо от частоты
+// отрисовки, а после кадра поток спит только остаток бюджета кадра (вместо SDL_Delay(16)
+// после каждого кадра, из-за которого при vsync пропускались интервалы экрана).
+
+#include <stdint.h>
+#include <chrono>
+
+// Режим темпа кадров (выбирается при запуске)
+enum PacingMode {
+    PACING_VSYNC,      // Темп задает SDL_RenderPresent с vsync, сна нет
+    PACING_TARGET_FPS, // Сон до начала следующего кадра заданной частоты
+    PACING_UNCAPPED    // Без ограничения: кадры рисуются сразу друг за другом
+};
+
+const char* pacingModeName(PacingMode mode);
+
+const double DEFAULT_UPDATE_HZ = 60;   // Частота шагов обновления игры
+const int MAX_UPDATES_PER_FRAME = 5;   // Больше шагов за кадр не догоняем (после долгого кадра)
+
+class FrameScheduler {
+public:
+    // fps - частота кадров для PACING_TARGET_FPS или частота экрана для PACING_VSYNC
+    void configure(PacingMode mode, double fps, double updateHz = DEFAULT_UPDATE_HZ);
+
+    // Начало кадра: сколько шагов обновления накопилось с прошлого кадра
+    int beginFrame();
+    // Конец кадра: сон до начала следующего кадра (возвращает время сна, мкс)
+    double endFrame();
+    // Выход из простоя (поток спал в ожидании событий): прошедшее время не догоняется
+    void resume();
+
+    PacingMode mode() const { return mode_; }
+    double fps() const { return fps_; }
+    double updateStep() const { return step_; }           // Шаг обновления, с
+    double alpha() const { return accumulator_ / step_; } // Доля шага, прошедшая после последнего обновления
+    uint64_t updates() const { return updates_; }          // Всего шагов обновления
+    uint64_t droppedUpdates() const { return dropped_; }   // Шагов, отброшенных MAX_UPDATES_PER_FRAME
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static void sleepUntil(Clock::time_point deadline);
+
+    PacingMode mode_ = PACING_VSYNC;
+    double fps_ = 60;
+    double step_ = 1 / DEFAULT_UPDATE_HZ;
+    Clock::duration period_ = Clock::duration::zero(); // Длительность кадра (0 - без ограничения)
+    Clock::time_point lastUpdate_;   // Когда накопитель последний раз пополнялся
+    Clock::time_point frameStart_;   // Начало текущего кадра
+    Clock::time_point nextFrame_;    // Начало следующего кадра в режиме PACING_TARGET_FPS
+    double accumulator_ = 0;         // Время, еще не покрытое шагами обновления, с
+    uint64_t updates_ = 0, dropped_ = 0;
+};
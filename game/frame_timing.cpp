@@ -0,0 +1,96 @@
+#include "frame_timing.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "wait", "events", "click", "logic", "update", "render_menu", "render_game", "render_lot", "render_win",
+    "overlay", "present", "delay", "frame"
+};
+
+const char* framePhaseName(FramePhase phase) {
+    return phase >= 0 && phase < PHASE_COUNT ? PHASE_NAMES[phase] : "?";
+}
+
+int RollingHistogram::bucketOf(double us) {
+    if (us < 1) return 0;
+    int b = 1 + (int)(log2(us) * 8);
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+// Функция добавления значения: самое старое значение окна уходит из своей корзины
+void RollingHistogram::add(double us) {
+    if (count_ == WINDOW) {
+        buckets_[bucketOf(samples_[next_])]--;
+        sum_ -= samples_[next_];
+    } else {
+        count_++;
+    }
+    samples_[next_] = (float)us;
+    buckets_[bucketOf(us)]++;
+    sum_ += (float)us;
+    next_ = (next_ + 1) % WINDOW;
+}
+
+double RollingHistogram::percentile(double p) const {
+    if (count_ == 0) return 0;
+    uint32_t rank = (uint32_t)ceil(p / 100 * count_);
+    if (rank == 0) rank = 1;
+    uint32_t seen = 0;
+    int b = 0;
+    for (; b < BUCKETS - 1; b++) {
+        seen += buckets_[b];
+        if (seen >= rank) break;
+    }
+    double upper = b == 0 ? 1.0 : exp2(b / 8.0);
+    double m = max();
+    return upper < m ? upper : m; // Граница корзины не больше самого большого значения окна
+}
+
+double RollingHistogram::max() const {
+    float m = 0;
+    for (int i = 0; i < count_; i++)
+        if (samples_[i] > m) m = samples_[i];
+    return m;
+}
+
+void FrameTiming::begin(FramePhase phase) {
+    Clock::time_point now = Clock::now();
+    if (depth_ > 0) current_[stack_[depth_ - 1]] += std::chrono::duration<double, std::micro>(now - stamp_).count();
+    if (depth_ < (int)(sizeof(stack_) / sizeof(stack_[0]))) stack_[depth_++] = phase;
+    seen_[phase] = true;
+    stamp_ = now;
+}
+
+void FrameTiming::end() {
+    if (depth_ == 0) return;
+    Clock::time_point now = Clock::now();
+    current_[stack_[--depth_]] += std::chrono::duration<double, std::micro>(now - stamp_).count();
+    stamp_ = now;
+}
+
+void FrameTiming::endFrame(bool rendered) {
+    double frame = 0;
+    for (int p = 0; p < PHASE_FRAME; p++) {
+        if (!seen_[p]) continue;
+        hist_[p].add(current_[p]);
+        if (p != PHASE_WAIT) frame += current_[p];
+        current_[p] = 0;
+        seen_[p] = false;
+    }
+    if (rendered) hist_[PHASE_FRAME].add(frame);
+}
+
+// Функция записи сводки: одна строка на часть кадра
+bool FrameTiming::writeCsv(const char* path, const char* build, const char* renderer) const {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "build,renderer,phase,samples,mean_us,p50_us,p90_us,p99_us,max_us\n");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        const RollingHistogram& h = hist_[p];
+        fprintf(f, "%s,%s,%s,%d,%.1f,%.1f,%.1f,%.1f,%.1f\n", build, renderer, PHASE_NAMES[p], h.size(),
+                h.mean(), h.percentile(50), h.percentile(90), h.percentile(99), h.max());
+    }
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+// Замер времени частей кадра главного цикла: ожидание событий, разбор событий, клики,
+// логика, обновление, каждая функция отрисовки, SDL_RenderPresent и сон до следующего кадра.
+// Время каждой части попадает в скользящую гистограмму последних кадров, по ней считаются p50/p99.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+
+enum FramePhase {
+    PHASE_WAIT,          // SDL_WaitEvent: поток спит, пока ничего не происходит (не входит в кадр)
+    PHASE_EVENTS,        // SDL_PollEvent
+    PHASE_CLICK,         // handleClick (в том числе генерация уровня по кнопке меню)
+    PHASE_LOGIC,         // Остальной разбор событий: клавиши, ходы, подсказки
+    PHASE_UPDATE,        // Шаги обновления игры с фиксированным шагом
+    PHASE_RENDER_MENU,
+    PHASE_RENDER_GAME,
+    PHASE_RENDER_LOT,
+    PHASE_RENDER_WIN,
+    PHASE_OVERLAY,       // Отрисовка самой панели замеров
+    PHASE_PRESENT,       // SDL_RenderPresent
+    PHASE_DELAY,         // Сон планировщика до следующего кадра
+    PHASE_FRAME,         // Весь кадр без PHASE_WAIT
+    PHASE_COUNT
+};
+
+// Имя части кадра для панели и CSV
+const char* framePhaseName(FramePhase phase);
+
+// Скользящая гистограмма: последние WINDOW значений, корзины по 1/8 октавы (точность ~9%)
+class RollingHistogram {
+public:
+    static const int WINDOW = 1024;
+    static const int BUCKETS = 192;     // До 2^23.8 мкс (~14 с)
+
+    void add(double us);
+    int size() const { return count_; }
+    double percentile(double p) const;  // Верхняя граница корзины (не больше максимума), мкс
+    double mean() const { return count_ ? sum_ / count_ : 0; }
+    double max() const;                 // Точный максимум по окну
+
+private:
+    static int bucketOf(double us);
+
+    float samples_[WINDOW];
+    int next_ = 0, count_ = 0;
+    uint32_t buckets_[BUCKETS] = {};
+    double sum_ = 0;
+};
+
+// Замер частей кадра: begin/end вкладываются, время вложенной части не входит в объемлющую
+class FrameTiming {
+public:
+    void begin(FramePhase phase);
+    void end();
+    // Конец итерации главного цикла: время частей уходит в гистограммы
+    // (кадр - только если он был нарисован)
+    void endFrame(bool rendered);
+
+    const RollingHistogram& histogram(FramePhase phase) const { return hist_[phase]; }
+    // Сводка по частям кадра в CSV (build и renderer - для сравнения сборок и машин)
+    bool writeCsv(const char* path, const char* build, const char* renderer) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    RollingHistogram hist_[PHASE_COUNT];
+    double current_[PHASE_COUNT] = {};  // Время частей в текущей итерации, мкс
+    bool seen_[PHASE_COUNT] = {};
+    FramePhase stack_[8];
+    int depth_ = 0;
+    Clock::time_point stamp_;
+};
+
+// Замер части кадра на время жизни объекта
+class PhaseScope {
+public:
+    PhaseScope(FrameTiming& timing, FramePhase phase) : timing_(timing) { timing_.begin(phase); }
+    ~PhaseScope() { timing_.end(); }
+
+private:
+    FrameTiming& timing_;
+};
@@ -0,0 +1,127 @@
+#include "glyph_atlas.h"
+#include "draw_stats.h"
+
+#include <stdio.h>
+#include <vector>
+
+const int ATLAS_WIDTH = 512;  // Ширина текстуры атласа, глифы укладываются полками
+const int ATLAS_PADDING = 1;  // Зазор между глифами против просачивания соседей при масштабировании
+
+// Функция построения атласа: все печатные ASCII-символы рисуются один раз в одну текстуру
+bool createGlyphAtlas(GlyphAtlas& atlas, SDL_Renderer* renderer, TTF_Font* font) {
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* glyphs[ATLAS_GLYPHS] = {};
+    atlas.height = TTF_FontHeight(font);
+
+    // Растеризация глифов и раскладка по полкам
+    int x = 0, y = 0, shelf = 0;
+    for (int i = 0; i < ATLAS_GLYPHS; i++) {
+        Uint16 ch = (Uint16)(ATLAS_FIRST_CHAR + i);
+        int minx, maxx, miny, maxy, advance = 0;
+        TTF_GlyphMetrics(font, ch, &minx, &maxx, &miny, &maxy, &advance);
+        atlas.advance[i] = advance;
+
+        glyphs[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        int w = glyphs[i] ? glyphs[i]->w : 0;
+        int h = glyphs[i] ? glyphs[i]->h : 0;
+        if (x + w > ATLAS_WIDTH) {
+            x = 0;
+            y += shelf + ATLAS_PADDING;
+            shelf = 0;
+        }
+        atlas.glyphs[i] = {x, y, w, h};
+        x += w + ATLAS_PADDING;
+        if (h > shelf) shelf = h;
+    }
+    atlas.textureW = ATLAS_WIDTH;
+    atlas.textureH = y + shelf;
+
+    // Копирование глифов в одну поверхность с альфа-каналом
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas.textureW, atlas.textureH, 32, SDL_PIXELFORMAT_RGBA32);
+    bool ok = sheet != NULL;
+    for (int i = 0; i < ATLAS_GLYPHS; i++) {
+        if (!glyphs[i]) continue;
+        if (ok) {
+            SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyphs[i], NULL, sheet, &atlas.glyphs[i]);
+        }
+        SDL_FreeSurface(glyphs[i]);
+    }
+
+    if (ok) {
+        atlas.texture = SDL_CreateTextureFromSurface(renderer, sheet);
+        SDL_FreeSurface(sheet);
+        ok = atlas.texture != NULL;
+    }
+    if (!ok) {
+        printf("Не удалось создать атлас шрифта! Ошибка: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+void destroyGlyphAtlas(GlyphAtlas& atlas) {
+    if (atlas.texture) SDL_DestroyTexture(atlas.texture);
+    atlas.texture = NULL;
+}
+
+// Номер глифа в атласе (неизвестные символы рисуются как '?')
+static int glyphIndex(char c) {
+    unsigned char ch = (unsigned char)c;
+    if (ch < ATLAS_FIRST_CHAR || ch > ATLAS_LAST_CHAR) ch = '?';
+    return ch - ATLAS_FIRST_CHAR;
+}
+
+int textWidth(const GlyphAtlas& atlas, const char* text) {
+    int w = 0;
+    for (const char* c = text; *c; c++) w += atlas.advance[glyphIndex(*c)];
+    return w;
+}
+
+// Функция отрисовки строки: по четырехугольнику на глиф, вся строка - один вызов SDL_RenderGeometry
+void drawText(SDL_Renderer* renderer, const GlyphAtlas& atlas, const char* text, SDL_Color color, const SDL_Rect& dst) {
+    // Буферы вершин переиспользуются между кадрами
+    static std::vector<SDL_Vertex> vertices;
+    static std::vector<int> indices;
+    vertices.clear();
+    indices.clear();
+
+    int width = textWidth(atlas, text);
+    if (width <= 0 || atlas.height <= 0) return;
+    float sx = (float)dst.w / width;
+    float sy = (float)dst.h / atlas.height;
+    float tw = (float)atlas.textureW, th = (float)atlas.textureH;
+
+    float pen = 0;
+    for (const char* c = text; *c; c++) {
+        int g = glyphIndex(*c);
+        const SDL_Rect& src = atlas.glyphs[g];
+        if (src.w > 0 && src.h > 0) {
+            float x0 = dst.x + pen * sx, y0 = (float)dst.y;
+            float x1 = x0 + src.w * sx, y1 = y0 + src.h * sy;
+            float u0 = src.x / tw, v0 = src.y / th;
+            float u1 = (src.x + src.w) / tw, v1 = (src.y + src.h) / th;
+
+            int base = (int)vertices.size();
+            vertices.push_back({{x0, y0}, color, {u0, v0}});
+            vertices.push_back({{x1, y0}, color, {u1, v0}});
+            vertices.push_back({{x1, y1}, color, {u1, v1}});
+            vertices.push_back({{x0, y1}, color, {u0, v1}});
+            const int quad[6] = {0, 1, 2, 0, 2, 3};
+            for (int k = 0; k < 6; k++) indices.push_back(base + quad[k]);
+        }
+        pen += atlas.advance[g];
+    }
+
+    if (!vertices.empty())
+        countDrawCall(SDL_RenderGeometry(renderer, atlas.texture, vertices.data(), (int)vertices.size(),
+                                         indices.data(), (int)indices.size()));
+}
+
+void drawTextCentered(SDL_Renderer* renderer, const GlyphAtlas& atlas, const char* text, SDL_Color color,
+                      const SDL_Rect& area) {
+    int w = textWidth(atlas, text);
+    SDL_Rect dst = {area.x + (area.w - w) / 2, area.y + (area.h - atlas.height) / 2, w, atlas.height};
+    drawText(renderer, atlas, text, color, dst);
+}
@@ -0,0 +1,31 @@
+#pragma once
+// Атлас глифов шрифта: текст рисуется четырехугольниками из одной текстуры,
+// без растеризации строк и создания текстур в каждом кадре
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+const int ATLAS_FIRST_CHAR = 32;   // Пробел
+const int ATLAS_LAST_CHAR = 126;   // '~'
+const int ATLAS_GLYPHS = ATLAS_LAST_CHAR - ATLAS_FIRST_CHAR + 1;
+
+// Атлас одного шрифта (белые глифы, цвет задается вершинами)
+struct GlyphAtlas {
+    SDL_Texture* texture = NULL;
+    int textureW = 0, textureH = 0;
+    SDL_Rect glyphs[ATLAS_GLYPHS];  // Область глифа в текстуре
+    int advance[ATLAS_GLYPHS];      // Сдвиг пера после глифа
+    int height = 0;                 // Высота строки шрифта
+};
+
+bool createGlyphAtlas(GlyphAtlas& atlas, SDL_Renderer* renderer, TTF_Font* font);
+void destroyGlyphAtlas(GlyphAtlas& atlas);
+
+// Ширина строки в пикселях при естественном размере шрифта
+int textWidth(const GlyphAtlas& atlas, const char* text);
+
+// Отрисовка строки, растянутой на прямоугольник dst (одним вызовом SDL_RenderGeometry)
+void drawText(SDL_Renderer* renderer, const GlyphAtlas& atlas, const char* text, SDL_Color color, const SDL_Rect& dst);
+// Отрисовка строки в естественном размере, отцентрованной в прямоугольнике area
+void drawTextCentered(SDL_Renderer* renderer, const GlyphAtlas& atlas, const char* text, SDL_Color color,
+                      const SDL_Rect& area);
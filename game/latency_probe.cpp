@@ -0,0 +1,85 @@
+#include "latency_probe.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+void LatencyProbe::input(uint32_t timestampMs, uint32_t nowMs) {
+    if (count_ == MAX_PENDING) {
+        ignored_++;
+        return;
+    }
+    Pending& p = pending_[count_++];
+    p.timestampMs = timestampMs;
+    p.handledMs = nowMs;
+    p.handled = Clock::now();
+    p.changed = false;
+}
+
+void LatencyProbe::reflected() {
+    if (count_ > 0) pending_[count_ - 1].changed = true;
+}
+
+// Функция замера после показа кадра: все изменившие парковку нажатия видны в этом кадре
+void LatencyProbe::presented(uint32_t nowMs) {
+    if (count_ == 0) return;
+    Clock::time_point now = Clock::now();
+    for (int i = 0; i < count_; i++) {
+        const Pending& p = pending_[i];
+        if (!p.changed) {
+            ignored_++;
+            continue;
+        }
+        float eventMs = (float)(uint32_t)(nowMs - p.timestampMs); // Счетчик SDL_GetTicks переполняется через 49 дней
+        eventMs_.push_back(eventMs);
+        queueMs_.push_back((float)(uint32_t)(p.handledMs - p.timestampMs));
+        handleUs_.push_back((float)std::chrono::duration<double, std::micro>(now - p.handled).count());
+        recent_.add(eventMs * 1000);
+    }
+    count_ = 0;
+}
+
+// Функция вывода перцентилей одной величины
+static void printPercentiles(const char* name, std::vector<float> v, const char* unit) {
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    printf("  %s: p50 %.3f, p90 %.3f, p99 %.3f, max %.3f %s\n", name, v[n / 2], v[std::min(n - 1, n * 9 / 10)],
+           v[std::min(n - 1, n * 99 / 100)], v.back(), unit);
+}
+
+void LatencyProbe::printSummary() const {
+    if (eventMs_.empty()) {
+        printf("Задержка ввода: нет нажатий, изменивших парковку (без хода: %zu)\n", ignored_);
+        return;
+    }
+    printf("Задержка ввода: %zu нажатий с ходом, %zu без хода\n", eventMs_.size(), ignored_);
+    printPercentiles("событие -> экран", eventMs_, "мс");
+    printPercentiles("событие -> обработка", queueMs_, "мс");
+    printPercentiles("обработка -> экран", handleUs_, "мкс");
+
+    // Доли по интервалам: сколько кадров 60 Гц заняла задержка
+    static const float bounds[] = {8, 17, 34, 50, 100};
+    const int groups = sizeof(bounds) / sizeof(bounds[0]) + 1;
+    size_t counts[groups] = {};
+    for (float ms : eventMs_) {
+        int g = 0;
+        while (g < groups - 1 && ms >= bounds[g]) g++;
+        counts[g]++;
+    }
+    for (int g = 0; g < groups; g++) {
+        char range[32];
+        if (g == 0) snprintf(range, sizeof(range), "< %.0f мс", bounds[0]);
+        else if (g == groups - 1) snprintf(range, sizeof(range), ">= %.0f мс", bounds[g - 1]);
+        else snprintf(range, sizeof(range), "%.0f-%.0f мс", bounds[g - 1], bounds[g]);
+        printf("  %s: %zu (%.1f%%)\n", range, counts[g], counts[g] * 100.0 / eventMs_.size());
+    }
+}
+
+bool LatencyProbe::writeCsv(const char* path) const {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "event_to_present_ms,event_to_handle_ms,handle_to_present_us\n");
+    for (size_t i = 0; i < eventMs_.size(); i++)
+        fprintf(f, "%.0f,%.0f,%.1f\n", eventMs_[i], queueMs_[i], handleUs_[i]);
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+// Замер задержки от нажатия клавиши до кадра на экране. Нажатие запоминается с отметкой
+// времени события SDL (e.key.timestamp, мс от SDL_Init) и моментом обработки; если оно сдвинуло
+// или повернуло машину, следующий кадр помечается как первый, где виден ход, и после возврата из
+// SDL_RenderPresent задержка попадает в распределение. Нажатия, которые ничего не изменили, не считаются.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+#include "frame_timing.h"
+
+class LatencyProbe {
+public:
+    // Нажатие клавиши в игре: timestampMs - e.key.timestamp, nowMs - SDL_GetTicks() при обработке
+    void input(uint32_t timestampMs, uint32_t nowMs);
+    // Последнее нажатие изменило парковку: его покажет следующий кадр
+    void reflected();
+    // SDL_RenderPresent вернулся (nowMs - SDL_GetTicks())
+    void presented(uint32_t nowMs);
+
+    bool pending() const { return count_ > 0; }  // Есть нажатия, еще не попавшие на экран
+    size_t samples() const { return eventMs_.size(); }
+    size_t ignored() const { return ignored_; }  // Нажатий без хода
+    // Последние замеры (событие -> кадр, мкс) для панели
+    const RollingHistogram& recent() const { return recent_; }
+
+    // Распределение задержек: перцентили и доли по интервалам
+    void printSummary() const;
+    // Все замеры в CSV, по строке на нажатие
+    bool writeCsv(const char* path) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Pending {
+        uint32_t timestampMs;    // Время события
+        uint32_t handledMs;      // Время обработки (для задержки в очереди событий)
+        Clock::time_point handled;
+        bool changed;            // Нажатие изменило парковку
+    };
+
+    static const int MAX_PENDING = 64; // Нажатий между двумя кадрами
+    Pending pending_[MAX_PENDING];
+    int count_ = 0;
+
+    std::vector<float> eventMs_;   // Событие -> SDL_RenderPresent, мс (точность отметки SDL - 1 мс)
+    std::vector<float> queueMs_;   // Событие -> обработка, мс
+    std::vector<float> handleUs_;  // Обработка -> SDL_RenderPresent, мкс
+    size_t ignored_ = 0;
+    RollingHistogram recent_;
+};
@@ -0,0 +1,244 @@
+#include "lot_view.h"
+#include "draw_stats.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+const int MIN_CELL_SIZE = 4;     // Меньше клетка не становится даже на 64x64 в маленьком окне
+const int MAX_CELL_SIZE = 60;    // Больше - как на исходной парковке 8x8
+
+// Функция расчета прямоугольника машины в слое (рамка в одну клетку вокруг поля)
+static SDL_Rect carLayerRect(const LotView& view, const Car& car) {
+    int cs = view.cellSize;
+    SDL_Rect r;
+    if (car.dir == UP || car.dir == DOWN) {
+        r.x = (car.x + 1) * cs;
+        r.y = ((car.dir == DOWN ? car.y : car.y - car.length + 1) + 1) * cs;
+        r.w = cs;
+        r.h = car.length * cs;
+    } else {
+        r.x = ((car.dir == RIGHT ? car.x : car.x - car.length + 1) + 1) * cs;
+        r.y = (car.y + 1) * cs;
+        r.w = car.length * cs;
+        r.h = cs;
+    }
+    return r;
+}
+
+static CarBatch batch; // Память вершин переиспользуется между кадрами
+
+// Функция добавления рамки выделенной машины (-1 - нет) со сдвигом (dx, dy): в буфер при batched,
+// иначе отдельным вызовом
+static void addLotSelection(const LotView& view, SDL_Renderer* renderer, const CarSheet& sheet, bool batched,
+                            int selected, int dx, int dy) {
+    if (selected < 0 || view.lot->car(selected).exited) return;
+    SDL_Rect rect = carLayerRect(view, view.lot->car(selected));
+    rect.x += dx;
+    rect.y += dy;
+    SDL_Color red = {255, 0, 0, 255};
+    if (batched) {
+        carBatchAddFrame(batch, sheet, rect, red);
+    } else {
+        SDL_SetRenderDrawColor(renderer, red.r, red.g, red.b, red.a);
+        countDrawCall(SDL_RenderDrawRect(renderer, &rect));
+    }
+}
+
+// Функция отрисовки набора машин (cars == NULL - всех): одним вызовом или по одной.
+// Рамка выделенной машины selected (-1 - нет) рисуется поверх машин, при batched - тем же вызовом.
+static void drawLotCars(const LotView& view, SDL_Renderer* renderer, const CarSheet& sheet, bool batched,
+                        const int* cars, int n, int selected = -1) {
+    carBatchClear(batch);
+    if (!cars) n = view.lot->carCount();
+    for (int k = 0; k < n; k++) {
+        const Car& car = view.lot->car(cars ? cars[k] : k);
+        if (car.exited) continue;
+        if (batched) carBatchAddCar(batch, sheet, carLayerRect(view, car), car.dir);
+        else drawCar(renderer, sheet, carLayerRect(view, car), car.dir);
+    }
+    addLotSelection(view, renderer, sheet, batched, selected, 0, 0);
+    carBatchDraw(batch, renderer, sheet);
+}
+
+// Функция расчета клетки и положения поля под область окна
+void layoutLotView(LotView& view, const LotBase* lot, int outW, int outH, int top) {
+    int cellW = outW / (lot->width() + 2);
+    int cellH = (outH - top) / (lot->height() + 2);
+    int cs = std::max(MIN_CELL_SIZE, std::min(MAX_CELL_SIZE, std::min(cellW, cellH)));
+
+    // Размер слоев меняется вместе с клеткой - старые текстуры больше не подходят
+    if (lot != view.lot || cs != view.cellSize) destroyLotView(view);
+    view.lot = lot;
+    view.cellSize = cs;
+    view.area.w = (lot->width() + 2) * cs;
+    view.area.h = (lot->height() + 2) * cs;
+    view.area.x = (outW - view.area.w) / 2;
+    view.area.y = top + (outH - top - view.area.h) / 2;
+    if (view.area.y < top) view.area.y = top;
+}
+
+void destroyLotView(LotView& view) {
+    if (view.boardLayer) SDL_DestroyTexture(view.boardLayer);
+    if (view.carLayer) SDL_DestroyTexture(view.carLayer);
+    view.boardLayer = NULL;
+    view.carLayer = NULL;
+    view.boardDirty = true;
+    view.carsDirty = true;
+    view.dirtyCells.clear();
+}
+
+// Функция учета клетки слоя машин для перерисовки (без повторов)
+static void markCell(LotView& view, int x, int y) {
+    for (const SDL_Point& p : view.dirtyCells)
+        if (p.x == x && p.y == y) return;
+    view.dirtyCells.push_back({x, y});
+}
+
+void lotViewCarChanged(LotView& view, const Car& before, const Car& after) {
+    if (view.carsDirty) return; // Слой все равно будет нарисован целиком
+    for (int i = 0; i < before.length; i++) {
+        int cx, cy;
+        carCell(before, i, &cx, &cy);
+        markCell(view, cx, cy);
+    }
+    for (int i = 0; i < after.length; i++) {
+        int cx, cy;
+        carCell(after, i, &cx, &cy);
+        markCell(view, cx, cy);
+    }
+}
+
+// Функция отрисовки неподвижной части поля в текущую цель (координаты слоя). При batched
+// парковка, препятствия и разметка - заливки из белого квадрата атласа одним вызовом; выезды
+// из своей текстуры рисуются отдельно (в буфер атласа машины они не попадают).
+static void drawLotBoard(const LotView& view, SDL_Renderer* renderer, const CarSheet& sheet, bool batched,
+                         SDL_Texture* exitTexture) {
+    const LotBase* lot = view.lot;
+    int cs = view.cellSize, w = lot->width(), h = lot->height(), ew = lot->exitWidth();
+    carBatchClear(batch);
+    auto fill = [&](const SDL_Rect& rect, SDL_Color color) {
+        if (batched) {
+            carBatchAddRect(batch, sheet, rect, color);
+        } else {
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+            countDrawCall(SDL_RenderFillRect(renderer, &rect));
+        }
+    };
+
+    // Отрисовка парковки (серый прямоугольник)
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    fill({cs, cs, w * cs, h * cs}, {126, 126, 126, 200});
+
+    // Отрисовка препятствий (темно-серые прямоугольники)
+    for (int i = 0; i < lot->obstacleCount(); i++) {
+        const Obstacle& ob = lot->obstacle(i);
+        fill({(ob.x + 1) * cs, (ob.y + 1) * cs, (ob.isHorizontal ? ob.length : 1) * cs,
+              (ob.isHorizontal ? 1 : ob.length) * cs}, {50, 50, 50, 255});
+    }
+
+    // Отрисовка разметки парковки (белые линии в один пиксель, концы включительно)
+    for (int i = 0; i <= w; i++) fill({(i + 1) * cs, cs, 1, h * cs + 1}, {255, 255, 255, 255});
+    for (int i = 0; i <= h; i++) fill({cs, (i + 1) * cs, w * cs + 1, 1}, {255, 255, 255, 255});
+    carBatchDraw(batch, renderer, sheet);
+
+    // Отрисовка выездов (центры сторон, как на парковке 8x8)
+    SDL_Rect exitRects[4] = {
+        {cs, (h / 2 - ew / 2 + 1) * cs, cs, ew * cs},       // Левый край
+        {w * cs, (h / 2 - ew / 2 + 1) * cs, cs, ew * cs},   // Правый край
+        {(w / 2 - ew / 2 + 1) * cs, cs, ew * cs, cs},       // Верхний край
+        {(w / 2 - ew / 2 + 1) * cs, h * cs, ew * cs, cs}    // Нижний край
+    };
+    for (int i = 0; i < 4; i++) countDrawCall(SDL_RenderCopy(renderer, exitTexture, NULL, &exitRects[i]));
+}
+
+// Функция перерисовки изменившихся клеток слоя машин: клетка очищается и машины в ней
+// рисуются заново в порядке номеров (как при полной отрисовке), с обрезкой по клетке
+static void redrawDirtyCells(LotView& view, SDL_Renderer* renderer, const CarSheet& sheet, bool batched) {
+    int cs = view.cellSize;
+    for (const SDL_Point& p : view.dirtyCells) {
+        SDL_Rect cell = {(p.x + 1) * cs, (p.y + 1) * cs, cs, cs};
+        if (cell.x < 0 || cell.y < 0 || cell.x >= view.area.w || cell.y >= view.area.h) continue;
+        SDL_RenderSetClipRect(renderer, &cell);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        countDrawCall(SDL_RenderFillRect(renderer, &cell));
+
+        int cars[MAX_CARS_IN_CELL];
+        int n = view.lot->carsAt(p.x, p.y, cars, MAX_CARS_IN_CELL);
+        drawLotCars(view, renderer, sheet, batched, cars, n);
+    }
+    SDL_RenderSetClipRect(renderer, NULL);
+    view.dirtyCells.clear();
+}
+
+// Функция создания текстуры-слоя размера поля
+static SDL_Texture* createLayer(SDL_Renderer* renderer, const LotView& view) {
+    SDL_Texture* t = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                       view.area.w, view.area.h);
+    if (!t) printf("Не удалось создать слой поля! Ошибка: %s\n", SDL_GetError());
+    else SDL_SetTextureBlendMode(t, SDL_BLENDMODE_BLEND);
+    return t;
+}
+
+// Функция отрисовки поля и машин
+void renderLotView(LotView& view, SDL_Renderer* renderer, const CarSheet& carSheet, bool batchCars,
+                   SDL_Texture* exitTexture, int selected) {
+    if (!view.lot) return;
+
+    if (view.useLayers && !view.boardLayer && SDL_RenderTargetSupported(renderer)) {
+        view.boardLayer = createLayer(renderer, view);
+        view.carLayer = view.boardLayer ? createLayer(renderer, view) : NULL;
+        view.boardDirty = view.carsDirty = true;
+    }
+
+    if (view.boardLayer && view.carLayer) {
+        if (view.boardDirty) {
+            SDL_SetRenderTarget(renderer, view.boardLayer);
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+            SDL_RenderClear(renderer);
+            drawLotBoard(view, renderer, carSheet, batchCars, exitTexture);
+            view.boardDirty = false;
+        }
+        if (view.carsDirty) {
+            SDL_SetRenderTarget(renderer, view.carLayer);
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+            SDL_RenderClear(renderer);
+            drawLotCars(view, renderer, carSheet, batchCars, NULL, 0);
+            view.carsDirty = false;
+            view.dirtyCells.clear();
+        } else if (!view.dirtyCells.empty()) {
+            SDL_SetRenderTarget(renderer, view.carLayer);
+            redrawDirtyCells(view, renderer, carSheet, batchCars);
+        }
+        SDL_SetRenderTarget(renderer, NULL);
+        countDrawCall(SDL_RenderCopy(renderer, view.boardLayer, NULL, &view.area));
+        countDrawCall(SDL_RenderCopy(renderer, view.carLayer, NULL, &view.area));
+
+        // Выделение выбранной машины рисуется поверх слоев: слой машин от него не зависит и
+        // не перерисовывается при смене выбора
+        carBatchClear(batch);
+        addLotSelection(view, renderer, carSheet, batchCars, selected, view.area.x, view.area.y);
+        carBatchDraw(batch, renderer, carSheet);
+    } else {
+        // Без текстур-целей (или без слоев) поле и все машины рисуются напрямую со смещением области
+        SDL_Rect viewport = view.area;
+        SDL_RenderSetViewport(renderer, &viewport);
+        drawLotBoard(view, renderer, carSheet, batchCars, exitTexture);
+        drawLotCars(view, renderer, carSheet, batchCars, NULL, 0, selected);
+        SDL_RenderSetViewport(renderer, NULL);
+        view.dirtyCells.clear();
+    }
+}
+
+// Функция выбора машины по точке окна
+int lotViewPick(const LotView& view, int x, int y) {
+    if (!view.lot || view.cellSize <= 0) return -1;
+    if (x < view.area.x || y < view.area.y || x >= view.area.x + view.area.w || y >= view.area.y + view.area.h)
+        return -1;
+    int gx = (x - view.area.x) / view.cellSize - 1;
+    int gy = (y - view.area.y) / view.cellSize - 1;
+
+    int cars[MAX_CARS_IN_CELL];
+    // Машина с наименьшим номером, как carAtCell на парковке 8x8
+    return view.lot->carsAt(gx, gy, cars, 1) > 0 ? cars[0] : -1;
+}
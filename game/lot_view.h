@@ -0,0 +1,39 @@
+#pragma once
+// Отображение парковки произвольного размера (LotBase): поле масштабируется под окно,
+// неподвижная часть и машины хранятся в двух текстурах-слоях. После хода в слое машин
+// перерисовываются только клетки, которые машина покинула и заняла, поэтому стоимость
+// кадра и хода не зависит от числа машин.
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+#include "lot.h"
+#include "car_batch.h"
+
+struct LotView {
+    const LotBase* lot = NULL;
+    int cellSize = 0;                   // Сторона клетки в пикселях
+    SDL_Rect area = {0, 0, 0, 0};       // Поле с рамкой в одну клетку (выезды) в координатах окна
+    SDL_Texture* boardLayer = NULL;     // Парковка, препятствия, разметка и выезды
+    SDL_Texture* carLayer = NULL;       // Машины на прозрачном фоне
+    bool boardDirty = true;             // Неподвижный слой нужно построить заново
+    bool carsDirty = true;              // Все машины нужно нарисовать заново
+    std::vector<SDL_Point> dirtyCells;  // Клетки слоя машин, изменившиеся после ходов
+    bool useLayers = true;              // false - поле и машины рисуются заново в каждом кадре (для сравнения)
+};
+
+// Расчет клетки и положения поля под область окна (outW x outH, сверху отступ top под надписи)
+void layoutLotView(LotView& view, const LotBase* lot, int outW, int outH, int top);
+void destroyLotView(LotView& view);
+
+// Учет хода: клетки машины до и после хода будут перерисованы в следующем кадре
+void lotViewCarChanged(LotView& view, const Car& before, const Car& after);
+
+// Отрисовка поля и машин; selected - выделенная машина (-1 - нет). При batchCars машины с рамкой
+// выделения рисуются одним вызовом SDL_RenderGeometry (рамка поверх слоев - своим), парковка,
+// препятствия и разметка - еще одним; иначе - по одному копированию кадра атласа и прямоугольнику.
+void renderLotView(LotView& view, SDL_Renderer* renderer, const CarSheet& carSheet, bool batchCars,
+                   SDL_Texture* exitTexture, int selected);
+
+// Машина под точкой окна (из нескольких - с наименьшим номером, как carAtCell), -1 - нет
+int lotViewPick(const LotView& view, int x, int y);
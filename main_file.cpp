@@ -1,75 +1,129 @@
 #include <SDL2/SDL.h>          // Основная библиотека SDL для работы с графикой, звуком и вводом
 #include <SDL2/SDL_image.h>    // Дополнение SDL для работы с изображениями
 #include <SDL2/SDL_ttf.h>      // Дополнение SDL для работы с шрифтами и текстом
-#include <stdlib.h>           // Стандартная библиотека C (для функций rand(), srand())
-#include <time.h>             // Библиотека для работы со временем (для srand(time(0)))
-#include <string>             // Библиотека для работы со строками C++
+#include <stdlib.h>           // Стандартная библиотека C
+#include <time.h>             // Библиотека для работы со временем (для зерна генератора уровней)
+#include <stdio.h>            // Форматирование строк (snprintf)
+#include <string.h>           // Разбор аргументов командной строки (strcmp)
 #include <iostream>
+#include <algorithm>          // Сортировка задержек подсказок
+#include <vector>
+#include <string>
+#include <chrono>             // Время запуска до первого кадра
+
+#include "parking.h"          // Игровая логика (библиотека parking_core)
+#include "level_generator.h"  // Генерация решаемых уровней на пуле потоков
+#include "glyph_atlas.h"      // Отрисовка текста из атласа глифов
+#include "draw_stats.h"       // Подсчет вызовов отрисовки за кадр
+#include "lot.h"              // Парковки произвольного размера
+#include "lot_view.h"         // Отображение больших парковок
+#include "car_batch.h"        // Все машины кадра одним вызовом отрисовки
+#include "asset_pack.h"       // Текстуры в формате рендерера для быстрого запуска
+#include "replay.h"           // Запись партий
+#include "move_journal.h"     // Отмена и повтор ходов
+#include "hint_engine.h"      // Подсказки (решатель в отдельном потоке)
+#include "frame_timing.h"     // Замер времени частей кадра
+#include "frame_scheduler.h"  // Темп кадров и обновление с фиксированным шагом
+#include "latency_probe.h"    // Задержка от нажатия до кадра
 
 // Константы игры
 const int SCREEN_WIDTH = 800;  // Ширина игрового окна в пикселях
 const int SCREEN_HEIGHT = 600; // Высота игрового окна в пикселях
-const int GRID_SIZE = 50;      // Размер одной клетки парковки в пикселях
-const int GRID_WIDTH = 8;     // Ширина парковки в клетках
-const int GRID_HEIGHT = 8;    // Высота парковки в клетках
-const int MAX_CARS = 20;       // Максимальное количество машин на парковке
-const int EXIT_WIDTH = 2;      // Ширина выезда с парковки в клетках
-const int LEFT_X = 200;        // Начало области парковки по х
-const int LEFT_Y = 100;         // Начало области парковки по y
-const int MINOBSTACLECOUNT = 3;  // Минимальное колличество препятствий
-
-// Направления движения машин
-enum Direction { UP, RIGHT, DOWN, LEFT };
 
 // Состояния игры (меню, игра, победа)
 enum GameState { MENU, PLAYING, WIN };
 
-// Структура, описывающая машину
-struct Car {
-    int x, y;               // Координаты головы машины (первой клетки)
-    int length;
-    Direction dir;          // Направление движения машины
-    SDL_Texture* texture;   // Текстура для отрисовки машины
-    bool isSelected;        // Флаг, выбрана ли машина игроком
-    bool exited;            // Флаг, выехала ли машина с парковки
-    SDL_Rect drawRect;      // Прямоугольник для отрисовки всей машины
-};
-
-struct Obstacle {
-    int x, y;           // Координаты препятствия
-    int length;         // Длина препятствия (1-5 клеток)
-    bool isHorizontal;  // true - горизонтальное, false - вертикальное
-};
-
 // Глобальные переменные
 SDL_Window* window = NULL;      // Указатель на окно приложения
 SDL_Renderer* renderer = NULL;  // Указатель на рендерер для отрисовки
 TTF_Font* font = NULL;          // Указатель на шрифт для текста
 TTF_Font* font_small = NULL;  
 TTF_Font* font_big = NULL;  
+GlyphAtlas fontAtlas;           // Атласы глифов шрифтов (строятся один раз при запуске)
+GlyphAtlas fontSmallAtlas;
+GlyphAtlas fontBigAtlas;
 GameState gameState = MENU;     // Текущее состояние игры (по умолчанию меню)
+bool frameDirty = true;         // Экран изменился и должен быть перерисован
 int difficulty = 1;             // Уровень сложности (1-3)
-Car cars[MAX_CARS];             // Массив машин на парковке
-int carCount = 0;               // Количество машин на парковке
+Parking parking;                // Машины, препятствия и карта занятости
 Car* selectedCar = NULL;        // Указатель на выбранную машину
-int moves = 0;                  // Количество сделанных ходов
-const int MAX_OBSTACLES = 20; // Максимальное количество препятствий
-Obstacle obstacles[MAX_OBSTACLES]; // Массив препятствий
-int obstacleCount = 0;  // Количество препятствий
+ParkingRng gameRng;             // Генератор зерен уровней
+LevelGenerator* levelGenerator = NULL; // Пул потоков генерации уровней
+Uint32 levelEventType = (Uint32)-1;    // Уровень, запрошенный из меню, готов
+uint64_t levelSeed = 0;                // Зерно запрошенного уровня
+
+// Режим большой парковки (--lot WxH): правила LotBase, поле масштабируется под окно
+int lotWidth = 0, lotHeight = 0;       // 0 - обычная парковка 8x8
+std::unique_ptr<LotBase> lot;          // Текущая большая парковка
+LotView lotView;                       // Ее отображение
+int selectedLotCar = -1;               // Номер выбранной машины (-1 - нет)
+const int LOT_HUD_HEIGHT = 50;         // Полоса надписей над большой парковкой
+
+// Запись партий: зерно уровня и действия игрока дописываются в файл (--replay FILE, --no-replay)
+ReplayWriter replayWriter;
+const char* replayPath = "replays.pkr";
+
+// Журнал ходов текущей партии: Ctrl+Z (Backspace) - отмена, Ctrl+Y (Ctrl+Shift+Z) - повтор
+MoveJournal moveJournal;
+
+// Подсказки (клавиша H, только парковка 8x8): решатель в своем потоке следит за каждым ходом,
+// готовая подсказка будит главный цикл событием hintEventType
+HintEngine* hintEngine = NULL;
+Uint32 hintEventType = (Uint32)-1;
+bool hintRequested = false;          // H нажата, подсказка еще не готова
+bool hintShown = false;              // Подсказка для текущей расстановки на экране
+Hint shownHint;
+Uint64 hintRequestTime = 0;          // Момент нажатия H (для замера задержки)
+std::vector<double> hintLatencies;   // Задержки от нажатия до готовой подсказки, мс
+
+// Замер частей кадра: F3 - панель p50/p99, F4 - сводка в CSV (--frame-csv FILE - еще и при выходе)
+FrameTiming frameTiming;
+bool showTimingOverlay = false;
+const char* frameCsvPath = "frame_times.csv";
+bool frameCsvOnExit = false;
+// Темп кадров выбирается при запуске: --vsync (по умолчанию), --fps N, --uncapped
+FrameScheduler frameScheduler;
+PacingMode pacingMode = PACING_VSYNC;
+double targetFps = 60;
+long long gameTicks = 0;        // Шагов обновления с запуска (анимации считаются в шагах, а не в кадрах)
+
+// Замер задержки от нажатия до кадра (--latency, распределение выводится при выходе).
+// --latency-inject N: N синтетических нажатий через SDL_PushEvent на парковке 8x8, затем выход
+LatencyProbe latencyProbe;
+bool probeLatency = false;
+const char* latencyCsvPath = NULL;     // --latency-csv FILE - все замеры в CSV
+int injectTotal = 0, injectRemaining = 0;
+Uint32 nextInjectTicks = 0;
+const Uint32 INJECT_INTERVAL_MS = 37;  // Не кратно кадру: нажатия попадают в разные моменты кадра
+
+#ifdef NDEBUG
+const char* BUILD_NAME = "release";
+#else
+const char* BUILD_NAME = "debug";
+#endif
 
 // Текстуры
 SDL_Texture* backgroundTexture = NULL; // Текстура фона
-SDL_Texture* carTexture = NULL;        // Текстура машины
 SDL_Texture* exitTexture = NULL;       // Текстура выезда
-SDL_Texture* winTexture = NULL;        // Текстура надписи "ПОБЕДА!"
-
-// Позиции выездов с парковки (центры сторон)
-SDL_Point exits[4] = {
-    {0, GRID_HEIGHT/2},             // Левый край
-    {GRID_WIDTH, GRID_HEIGHT/2},  // Правый край
-    {GRID_WIDTH/2, 0},              // Верхний край
-    {GRID_WIDTH/2, GRID_HEIGHT}   // Нижний край
-};
+SDL_Texture* boardTexture = NULL;      // Кэш неподвижной части поля (фон, парковка, препятствия, выезды)
+bool boardDirty = true;                // Кэш поля нужно построить заново
+bool useBoardCache = true;             // Отключается флагом --no-board-cache для сравнения
+CarSheet carSheet;                     // Атлас машины: кадр на каждое направление и белый квадрат для рамок
+CarBatch carBatch;                     // Вершины машин текущего кадра
+bool useCarBatch = true;               // Отключается флагом --no-car-batch для сравнения
+
+// Пакет текстур assets.pack рядом с игрой (--asset-pack FILE - другой файл, --no-asset-pack - только
+// исходные изображения) и время запуска от входа в main до первого показанного кадра
+const char* assetPackPath = NULL;
+bool useAssetPack = true;
+std::chrono::steady_clock::time_point startTime;
+double assetLoadMs = 0;
+bool assetsFromPack = false;
+bool startupReported = false;
+
+// Статистика вызовов отрисовки на экране игры
+long long gameFrames = 0;
+long long gameDrawCalls = 0;
 
 // Функция загрузки текстуры из файла
 SDL_Texture* loadTexture(const char* path, int* w = nullptr, int* h = nullptr) {
@@ -94,24 +148,81 @@ SDL_Texture* loadTexture(const char* path, int* w = nullptr, int* h = nullptr) {
     return texture;
 }
 
-// Функция создания текстуры из текста
-SDL_Texture* createTextTexture(const char* text, SDL_Color color, TTF_Font* font_in = font) {
-    // Создание поверхности с текстом
-    SDL_Surface* surface = TTF_RenderText_Solid(font_in, text, color);
-    if (!surface) {
-        printf("Не удалось создать поверхность из текста! Ошибка: %s\n", TTF_GetError());
-        return NULL;
+// Функция освобождения текстур из assets (после неудачной загрузки из пакета)
+void destroyAssetTextures() {
+    if (backgroundTexture) SDL_DestroyTexture(backgroundTexture);
+    if (exitTexture) SDL_DestroyTexture(exitTexture);
+    destroyCarSheet(carSheet);
+    backgroundTexture = exitTexture = NULL;
+}
+
+// Функция загрузки текстур из пакета: пиксели уже в формате рендерера и передаются без декодирования
+bool loadAssetPack() {
+    std::string path;
+    if (assetPackPath) {
+        path = assetPackPath;
+    } else {
+        char* base = SDL_GetBasePath(); // Пакет собирается рядом с исполняемым файлом
+        path = std::string(base ? base : "") + "assets.pack";
+        SDL_free(base);
     }
 
-    // Создание текстуры из поверхности
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface); // Освобождение поверхности
-    
-    if (!texture) {
-        printf("Не удалось создать текстуру из текста! Ошибка: %s\n", SDL_GetError());
+    AssetPack pack;
+    if (!pack.open(path.c_str())) return false;
+    if (!pack.supports(renderer)) {
+        printf("Рендерер не принимает формат пакета текстур %s, загружаются исходные изображения\n",
+               SDL_GetPixelFormatName(pack.format()));
+        return false;
+    }
+    backgroundTexture = pack.createTexture(renderer, "background");
+    exitTexture = pack.createTexture(renderer, "exit");
+    const AssetEntry* car = pack.find("car_sheet");
+    if (car) {
+        layoutCarSheet(carSheet, car->sourceW, car->sourceH);
+        if (car->w == carSheet.textureW && car->h == carSheet.textureH)
+            carSheet.texture = pack.createTexture(renderer, "car_sheet");
     }
+    if (backgroundTexture && exitTexture && carSheet.texture) return true;
 
-    return texture;
+    printf("Пакет текстур %s не подходит, загружаются исходные изображения\n", path.c_str());
+    destroyAssetTextures();
+    return false;
+}
+
+// Функция загрузки текстур из исходных изображений
+bool loadAssetImages() {
+    backgroundTexture = loadTexture("assets/background.png"); // Фон
+    exitTexture = loadTexture("assets/exit.png");            // Выезд
+
+    // Машина: изображение разворачивается в атлас с кадром на каждое направление
+    SDL_Surface* carSurface = IMG_Load("assets/car.png");
+    if (!carSurface) {
+        printf("Не удалось загрузить изображение assets/car.png! Ошибка: %s\n", IMG_GetError());
+        return false;
+    }
+    bool sheetOk = createCarSheet(carSheet, renderer, carSurface);
+    SDL_FreeSurface(carSurface);
+
+    // Проверка, что все текстуры загружены успешно
+    return backgroundTexture && exitTexture && sheetOk;
+}
+
+// Функция настройки темпа кадров: без vsync у рендерера темп держит сон до частоты экрана
+void setupPacing() {
+    SDL_DisplayMode mode;
+    int refresh = 60;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &mode) == 0 && mode.refresh_rate > 0)
+        refresh = mode.refresh_rate;
+
+    SDL_RendererInfo info;
+    if (pacingMode == PACING_VSYNC && (SDL_GetRendererInfo(renderer, &info) != 0 || !(info.flags & SDL_RENDERER_PRESENTVSYNC))) {
+        printf("Рендерер не поддерживает vsync, кадры ограничиваются частотой экрана %d Гц\n", refresh);
+        pacingMode = PACING_TARGET_FPS;
+        targetFps = refresh;
+    }
+    frameScheduler.configure(pacingMode, pacingMode == PACING_VSYNC ? refresh : targetFps);
+    if (pacingMode == PACING_UNCAPPED) printf("Темп кадров: без ограничения\n");
+    else printf("Темп кадров: %s, %.0f кадров/с\n", pacingModeName(pacingMode), frameScheduler.fps());
 }
 
 // Функция инициализации SDL и всех подсистем
@@ -135,41 +246,58 @@ bool initSDL() {
     }
 
     // Создание окна приложения
+    // Размер окна можно менять: меню и парковка 8x8 растягиваются, большая парковка подстраивает клетку
     window = SDL_CreateWindow("Выезд с парковки", SDL_WINDOWPOS_UNDEFINED, 
-                            SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+                            SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT,
+                            SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
     if (!window) {
         printf("Ошибка создания окна: %s\n", SDL_GetError());
         return false;
     }
 
     // Создание рендерера для отрисовки в окне
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (pacingMode == PACING_VSYNC) rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (!renderer) {
         printf("Ошибка создания рендерера: %s\n", SDL_GetError());
         return false;
     }
+    setupPacing();
+    SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT); // Координаты 800x600 при любом окне
 
     // Загрузка шрифта из файла
     font = TTF_OpenFont("font/arial.ttf", 24);
     font_small = TTF_OpenFont("font/arial.ttf", 12);
     font_big = TTF_OpenFont("font/arial.ttf", 48);
-    if (!font) {
+    if (!font || !font_small || !font_big) {
         printf("Не удалось загрузить шрифт! Ошибка: %s\n", TTF_GetError());
         return false;
     }
 
-    // Загрузка всех необходимых текстур
-    int carTexW, carTexH;
-    backgroundTexture = loadTexture("assets/background.png"); // Фон
-    carTexture = loadTexture("assets/car.png", &carTexW, &carTexH);              // Машина
-    exitTexture = loadTexture("assets/exit.png");            // Выезд
-    winTexture = createTextTexture("WIN!", {255, 255, 51, 255}, font_big); // Текст победы
-
-    // Проверка, что все текстуры загружены успешно
-    if (!backgroundTexture || !carTexture || !exitTexture || !winTexture) {
+    // Построение атласов глифов для всех шрифтов
+    if (!createGlyphAtlas(fontAtlas, renderer, font) ||
+        !createGlyphAtlas(fontSmallAtlas, renderer, font_small) ||
+        !createGlyphAtlas(fontBigAtlas, renderer, font_big)) {
         return false;
     }
 
+    // Загрузка всех необходимых текстур: из пакета, если он есть и подходит рендереру, иначе из изображений
+    auto assetStart = std::chrono::steady_clock::now();
+    assetsFromPack = useAssetPack && loadAssetPack();
+    if (!assetsFromPack && !loadAssetImages()) return false;
+    assetLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - assetStart).count();
+
+    // Текстура-цель для кэша поля (без нее поле рисуется напрямую в каждом кадре)
+    if (useBoardCache && SDL_RenderTargetSupported(renderer)) {
+        boardTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                         SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (!boardTexture)
+            printf("Не удалось создать текстуру поля, кэш отключен! Ошибка: %s\n", SDL_GetError());
+        else
+            SDL_SetTextureBlendMode(boardTexture, SDL_BLENDMODE_NONE);
+    }
+
     return true;
 }
 
@@ -177,12 +305,18 @@ bool initSDL() {
 void closeSDL() {
     // Удаление всех текстур
     SDL_DestroyTexture(backgroundTexture);
-    SDL_DestroyTexture(carTexture);
+    destroyCarSheet(carSheet);
     SDL_DestroyTexture(exitTexture);
-    SDL_DestroyTexture(winTexture);
+    if (boardTexture) SDL_DestroyTexture(boardTexture);
+    destroyLotView(lotView);
+    destroyGlyphAtlas(fontAtlas);
+    destroyGlyphAtlas(fontSmallAtlas);
+    destroyGlyphAtlas(fontBigAtlas);
     
-    // Закрытие шрифта
+    // Закрытие шрифтов
     TTF_CloseFont(font);
+    TTF_CloseFont(font_small);
+    TTF_CloseFont(font_big);
     // Удаление рендерера и окна
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -193,373 +327,37 @@ void closeSDL() {
     SDL_Quit();
 }
 
-
-
-// Функция проверки, свободна ли указанная клетка
-bool isCellFree(int x, int y) {
-    // Проверка, не находится ли клетка на выезде
-    for (int i = 0; i < 4; i++) {
-        if ((x == exits[i].x && abs(y - exits[i].y) <= EXIT_WIDTH/2) ||
-            (y == exits[i].y && abs(x - exits[i].x) <= EXIT_WIDTH/2)) {
-            return true; // Клетка на выезде считается свободной
-        }
-    }
-
-    // Проверка выхода за границы парковки
-    if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT)
-        return false;
-
-
-        // Проверка всех препятствий
-    for (int i = 0; i < obstacleCount; i++) {
-        if (obstacles[i].isHorizontal) {
-            // Горизонтальное препятствие
-            if (y == obstacles[i].y && x >= obstacles[i].x && x < obstacles[i].x + obstacles[i].length) {
-                return false;
-            }
-        } else {
-            // Вертикальное препятствие
-            if (x == obstacles[i].x && y >= obstacles[i].y && y < obstacles[i].y + obstacles[i].length) {
-                return false;
-            }
-        }
-    }
-
-    // Проверка всех машин на парковке
-    for (int i = 0; i < carCount; i++) {
-        if (cars[i].exited) continue; // Пропустить машины, которые уже выехали
-
-        // Для вертикальных машин (движутся вверх/вниз)
-        if (cars[i].dir == UP || cars[i].dir == DOWN) {
-            for (int j = 0; j < cars[i].length; j++) {
-                int cy = cars[i].y + (cars[i].dir == DOWN ? j : -j);
-                if (cars[i].x == x && cy == y)
-                    return false; // Клетка занята машиной
-            }
-        } 
-        // Для горизонтальных машин (движутся влево/вправо)
-        else {
-            for (int j = 0; j < cars[i].length; j++) {
-                int cx = cars[i].x + (cars[i].dir == RIGHT ? j : -j);
-                if (cx == x && cars[i].y == y)
-                    return false; // Клетка занята машиной
-            }
-        }
-    }
-    return true; // Клетка свободна
-}
-
-//Функция для генерации препятствий
-void generateObstacles() {
-    obstacleCount = 0;
-    srand(time(0));
-
-    // Количество препятствий зависит от сложности
-    int numObstacles = MINOBSTACLECOUNT + (difficulty - 1) * 2;
-    
-    for (int i = 0; i < numObstacles && obstacleCount < MAX_OBSTACLES; i++) {
-        Obstacle obs;
-        obs.length = 1 + rand() % 5; // Длина от 1 до 5
-        obs.isHorizontal = rand() % 2 == 0; // Случайная ориентация
-
-        bool placed = false;
-        int attempts = 0;
-
-        while (!placed && attempts < 100) {
-            attempts++;
-            
-            if (obs.isHorizontal) {
-                obs.x = rand() % (GRID_WIDTH - obs.length + 1);
-                obs.y = 1 + rand() % (GRID_HEIGHT - 2); // Не на границах
-            } else {
-                obs.x = 1 + rand() % (GRID_WIDTH - 2); // Не на границах
-                obs.y = rand() % (GRID_HEIGHT - obs.length + 1);
-            }
-
-            // Проверка, что препятствие не пересекается с другими
-            placed = true;
-            for (int j = 0; j < obs.length; j++) {
-                int ox = obs.isHorizontal ? obs.x + j : obs.x;
-                int oy = obs.isHorizontal ? obs.y : obs.y + j;
-                
-                if (!isCellFree(ox, oy)) {
-                    placed = false;
-                    break;
-                }
-            }
-        }
-
-        if (placed) {
-            obstacles[obstacleCount++] = obs;
-        }
-    }
-}
-//Функция для расчета формы машины
-SDL_Rect calculateCarRect(const Car& car) {
-    SDL_Rect rect;
-    
-    if (car.dir == UP || car.dir == DOWN) {
-        // Вертикальные машины (2 клетки в высоту)
-        rect.x = LEFT_X + car.x * GRID_SIZE;
-        rect.y = LEFT_Y + (car.dir == DOWN ? car.y : car.y - 1) * GRID_SIZE;
-        rect.w = GRID_SIZE;
-        rect.h = 2 * GRID_SIZE; // Фиксированная длина
-    } else {
-        // Горизонтальные машины (2 клетки в ширину)
-        rect.x = LEFT_X + (car.dir == RIGHT ? car.x : car.x - 1) * GRID_SIZE;
-        rect.y = LEFT_Y + car.y * GRID_SIZE;
-        rect.w = 2 * GRID_SIZE; // Фиксированная длина
-        rect.h = GRID_SIZE;
-    }
-    
+// Перевод прямоугольника игровой логики в SDL_Rect
+inline SDL_Rect toSDLRect(const Rect& r) {
+    SDL_Rect rect = {r.x, r.y, r.w, r.h};
     return rect;
 }
-// Функция генерации случайной парковки
-void generateParking() {
-    carCount = 0;       // Сброс количества машин
-    moves = 0;          // Сброс счетчика ходов
-    selectedCar = NULL; // Сброс выбранной машины
-    srand(time(0));     // Инициализация генератора случайных чисел
-
-    generateObstacles(); // Генерация препятствий
-
-    // Количество машин зависит от сложности
-    int numCars = 10 + (difficulty - 1) * 5;
-    
-    
-
-    // Генерация машин
-    for (int i = 0; i < numCars; i++) {
-        Car car;
-        car.length = 2; // Длина 2 
-        car.dir = static_cast<Direction>(rand() % 4); // Случайное направление
-        car.texture = carTexture;      // Текстура машины
-        car.isSelected = false;        // Изначально не выбрана
-        car.exited = false;            // Изначально не выехала
-
-        bool placed = false; // Флаг, размещена ли машина
-        int attempts = 0;    // Счетчик попыток размещения
-
-        // Попытки разместить машину на парковке
-        while (!placed && attempts < 1000) {
-            attempts++;
-            
-            // Генерация случайных координат в зависимости от направления
-            if (car.dir == UP || car.dir == DOWN) {
-                car.x = rand() % GRID_WIDTH;
-                car.y = rand() % (GRID_HEIGHT - car.length + 1);
-            } else {
-                car.x = rand() % (GRID_WIDTH - car.length + 1);
-                car.y = rand() % GRID_HEIGHT;
-            }
-
-            car.drawRect = calculateCarRect(car);
-
-            placed = true; // Предполагаем, что размещение удалось
-            // Проверка всех клеток, которые займет машина
-            for (int j = 0; j < car.length; j++) {
-                int cx, cy;
-                
-                if (car.dir == UP || car.dir == DOWN) {
-                    cx = car.x;
-                    cy = car.y + (car.dir == DOWN ? j : -j);
-                } else {
-                    cx = car.x + (car.dir == RIGHT ? j : -j);
-                    cy = car.y;
-                }
-
-                // Проверка, не находится ли клетка на выезде
-                for (int e = 0; e < 4; e++) {
-                    if ((cx == exits[e].x && abs(cy - exits[e].y) <= EXIT_WIDTH/2) ||
-                        (cy == exits[e].y && abs(cx - exits[e].x) <= EXIT_WIDTH/2)) {
-                        placed = false; // Нельзя ставить машину на выезд
-                        break;
-                    }
-                }
-
-                if (!placed) break;
-
-                // Проверка, свободна ли клетка
-                if (!isCellFree(cx, cy)) {
-                    placed = false;
-                    break;
-                }
-            }
-        }
-
-        // Если машину удалось разместить, добавляем ее в массив
-        if (placed) {
-            cars[carCount++] = car;
-        }
-    }
-}
-
-
-
-// Функция проверки, может ли машина двигаться в указанном направлении
-bool canMove(const Car* car, int dx, int dy) {
-    if (car->exited) return false; // Уже выехавшие машины не могут двигаться
-
-    // Проверка всех клеток, которые займет машина после движения
-    for (int i = 0; i < car->length; i++) {
-        int cx, cy;
-        
-        if (car->dir == UP || car->dir == DOWN) {
-            cx = car->x + dx;
-            cy = car->y + (car->dir == DOWN ? i : -i) + dy;
-        } else {
-            cx = car->x + (car->dir == RIGHT ? i : -i) + dx;
-            cy = car->y + dy;
-        }
-
-        // Проверка, не находится ли клетка на выезде
-        bool isExit = false;
-        for (int e = 0; e < 4; e++) {
-            if ((cx == exits[e].x && abs(cy - exits[e].y) <= EXIT_WIDTH/2) ||
-                (cy == exits[e].y && abs(cx - exits[e].x) <= EXIT_WIDTH/2)) {
-                isExit = true;
-                break;
-            }
-        }
-        
-        if (isExit) continue; // Выезд считается допустимым
-
-        // Проверка, свободна ли клетка
-        if (!isCellFree(cx, cy)) {
-            // Проверка, не является ли занятая клетка частью этой же машины
-            bool isOurCar = false;
-            for (int j = 0; j < car->length; j++) {
-                int ox, oy;
-                if (car->dir == UP || car->dir == DOWN) {
-                    ox = car->x;
-                    oy = car->y + (car->dir == DOWN ? j : -j);
-                } else {
-                    ox = car->x + (car->dir == RIGHT ? j : -j);
-                    oy = car->y;
-                }
-                
-                if (ox == cx && oy == cy) {
-                    isOurCar = true;
-                    break;
-                }
-            }
-            
-            // Если клетка занята другой машиной, движение невозможно
-            if (!isOurCar)
-                return false;
-        }
-    }
-    return true; // Все клетки свободны или на выезде
-}
-
-// Функция перемещения машины
-void moveCar(Car* car, int dx, int dy) {
-    if (!canMove(car, dx, dy)) return; // Проверка возможности движения
-
-    // Изменение координат машины
-    car->x += dx;
-    car->y += dy;
-    moves++; // Увеличение счетчика ходов
-    car->drawRect = calculateCarRect(*car); // Обновляем прямоугольник отрисовки
-
-    // Проверка, выехала ли машина полностью
-    bool exited = true;
-    for (int i = 0; i < car->length; i++) {
-        int cx, cy;
-        
-        if (car->dir == UP || car->dir == DOWN) {
-            cx = car->x;
-            cy = car->y + (car->dir == DOWN ? i : -i);
-        } else {
-            cx = car->x + (car->dir == RIGHT ? i : -i);
-            cy = car->y;
-        }
-
-        // Проверка, находится ли клетка на выезде
-        bool onExit = false;
-        for (int e = 0; e < 4; e++) {
-            if ((cx == exits[e].x && abs(cy - exits[e].y) <= EXIT_WIDTH/2) ||
-                (cy == exits[e].y && abs(cx - exits[e].x) <= EXIT_WIDTH/2)) {
-                onExit = true;
-                break;
-            }
-        }
-
-        // Если хотя бы одна клетка не на выезде, машина не выехала
-        if (!onExit) {
-            exited = false;
-            break;
-        }
-    }
-
-    car->exited = exited; // Установка флага выезда
-}
-
-// Функция только для поворота машины
-void rotateCar(Car* car, bool turnLeft) {
-    if (!car || car->exited) return;
-
-    // Поворачиваем машину
-    if (turnLeft) {
-        // Поворот налево (против часовой стрелки)
-        switch (car->dir) {
-            case UP:    car->dir = LEFT; break;
-            case LEFT:  car->dir = DOWN; break;
-            case DOWN:  car->dir = RIGHT; break;
-            case RIGHT: car->dir = UP; break;
-        }
-    } else {
-        // Поворот направо (по часовой стрелке)
-        switch (car->dir) {
-            case UP:    car->dir = RIGHT; break;
-            case RIGHT: car->dir = DOWN; break;
-            case DOWN:  car->dir = LEFT; break;
-            case LEFT:  car->dir = UP; break;
-        }
-    }
-
-    // Обновляем прямоугольник отрисовки (если нужно)
-    car->drawRect = calculateCarRect(*car);
-}
-
-// Функция проверки условия победы (все машины выехали)
-bool checkWin() {
-    for (int i = 0; i < carCount; i++) {
-        if (!cars[i].exited)
-            return false; // Найдена не выехавшая машина
-    }
-    return true; // Все машины выехали
-}
 
 // Функция отрисовки меню
 void renderMenu() {
     // Отрисовка фона
-    SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
+    countDrawCall(SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL));
 
     //Отрисовка черного полупрозрачного прямоугольника
     SDL_SetRenderDrawColor(renderer, 0,0,0,128);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_Rect back = {200, 145, 400, 300};
-    SDL_RenderFillRect(renderer, &back);
+    countDrawCall(SDL_RenderFillRect(renderer, &back));
 
     //Author
     SDL_SetRenderDrawColor(renderer, 0,0,0,200);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_Rect backauthor = {175, 575, 455, 30};
-    SDL_RenderFillRect(renderer, &backauthor);
+    countDrawCall(SDL_RenderFillRect(renderer, &backauthor));
     SDL_Color blue = {0, 192, 255, 255};
-    SDL_Texture* author = createTextTexture("Aleksey_Krechetov_M3O-121BV-24", blue, font_small);
     SDL_Rect authorRect = {180, 580, 450, 15};
-    SDL_RenderCopy(renderer, author, NULL, &authorRect);
-    SDL_DestroyTexture(author); // Удаление временной текстуры
+    drawText(renderer, fontSmallAtlas, "Aleksey_Krechetov_M3O-121BV-24", blue, authorRect);
 
 
     // Создание и отрисовка текста заголовка
     SDL_Color white = {255, 255, 255, 255};
-    SDL_Texture* title = createTextTexture("Parking escape", white);
     SDL_Rect titleRect = {SCREEN_WIDTH/2 - 150, 150, 300, 60};
-    SDL_RenderCopy(renderer, title, NULL, &titleRect);
-    SDL_DestroyTexture(title); // Удаление временной текстуры
+    drawText(renderer, fontAtlas, "Parking escape", white, titleRect);
 
     // Массивы для кнопок сложности
     const char* difficulties[] = {"Low", "Medium", "High"};
@@ -571,23 +369,19 @@ void renderMenu() {
         
         // Отрисовка прямоугольника кнопки
         SDL_SetRenderDrawColor(renderer, colors[i].r, colors[i].g, colors[i].b, colors[i].a);
-        SDL_RenderFillRect(renderer, &buttonRect);
+        countDrawCall(SDL_RenderFillRect(renderer, &buttonRect));
         
-        // Создание и отрисовка текста на кнопке
-        SDL_Texture* text = createTextTexture(difficulties[i], white);
-        int textW, textH;
-        SDL_QueryTexture(text, NULL, NULL, &textW, &textH);
-        SDL_Rect textRect = {
-            buttonRect.x + (buttonRect.w - textW)/2,
-            buttonRect.y + (buttonRect.h - textH)/2,
-            textW,
-            textH
-        };
-        SDL_RenderCopy(renderer, text, NULL, &textRect);
-        SDL_DestroyTexture(text); // Удаление временной текстуры
+        // Отрисовка текста на кнопке
+        drawTextCentered(renderer, fontAtlas, difficulties[i], white, buttonRect);
     }
 
-    SDL_RenderPresent(renderer); // Обновление экрана
+    // Уровень генерируется в фоне
+    if (levelGenerator->requestPending()) {
+        char text[32];
+        snprintf(text, sizeof(text), "Generating level%.*s", (int)(gameTicks / 15 % 4), "...");
+        SDL_Rect textRect = {SCREEN_WIDTH/2 - 150, 412, 300, 30};
+        drawTextCentered(renderer, fontSmallAtlas, text, white, textRect);
+    }
 }
 
 // Функция отрисовки выездов с парковки
@@ -600,7 +394,7 @@ void renderExits() {
                 GRID_SIZE,
                 EXIT_WIDTH * GRID_SIZE
             };
-            SDL_RenderCopy(renderer, exitTexture, NULL, &exitRect);
+            countDrawCall(SDL_RenderCopy(renderer, exitTexture, NULL, &exitRect));
         } else { // Вертикальные выезды (верхний и нижний)
             SDL_Rect exitRect = {
                 LEFT_X + (exits[i].x - EXIT_WIDTH/2) * GRID_SIZE,
@@ -608,170 +402,378 @@ void renderExits() {
                 EXIT_WIDTH * GRID_SIZE,
                 GRID_SIZE
             };
-            SDL_RenderCopy(renderer, exitTexture, NULL, &exitRect);
+            countDrawCall(SDL_RenderCopy(renderer, exitTexture, NULL, &exitRect));
         }
     }
 }
 
-// Функция отрисовки игрового поля
-void renderGame() {
+// Функция отрисовки неподвижной части поля: фон, парковка, препятствия, разметка и выезды
+void renderBoard() {
     // Отрисовка фона
-    SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
+    countDrawCall(SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL));
 
     //Отрисовка черного полупрозрачного прямоугольника
     SDL_SetRenderDrawColor(renderer, 0,0,0,128);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_Rect back = {15, 15, 160, 75};
-    SDL_RenderFillRect(renderer, &back);
+    countDrawCall(SDL_RenderFillRect(renderer, &back));
 
     // Отрисовка парковки (серый прямоугольник)
-    SDL_Rect parking = {LEFT_X, LEFT_Y, GRID_WIDTH*GRID_SIZE, GRID_HEIGHT*GRID_SIZE};
+    SDL_Rect lot = {LEFT_X, LEFT_Y, GRID_WIDTH*GRID_SIZE, GRID_HEIGHT*GRID_SIZE};
     SDL_SetRenderDrawColor(renderer, 126, 126, 126, 200); // Полупрозрачный серый
-    SDL_RenderFillRect(renderer, &parking);
+    countDrawCall(SDL_RenderFillRect(renderer, &lot));
 
     // Отрисовка препятствий (темно-серые прямоугольники)
     SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
-    for (int i = 0; i < obstacleCount; i++) {
-        if (obstacles[i].isHorizontal) {
+    for (int i = 0; i < parking.obstacleCount; i++) {
+        if (parking.obstacles[i].isHorizontal) {
             SDL_Rect obsRect = {
-                LEFT_X + obstacles[i].x * GRID_SIZE,
-                LEFT_Y + obstacles[i].y * GRID_SIZE,
-                obstacles[i].length * GRID_SIZE,
+                LEFT_X + parking.obstacles[i].x * GRID_SIZE,
+                LEFT_Y + parking.obstacles[i].y * GRID_SIZE,
+                parking.obstacles[i].length * GRID_SIZE,
                 GRID_SIZE
             };
-            SDL_RenderFillRect(renderer, &obsRect);
+            countDrawCall(SDL_RenderFillRect(renderer, &obsRect));
         } else {
             SDL_Rect obsRect = {
-                LEFT_X + obstacles[i].x * GRID_SIZE,
-                LEFT_Y + obstacles[i].y * GRID_SIZE,
+                LEFT_X + parking.obstacles[i].x * GRID_SIZE,
+                LEFT_Y + parking.obstacles[i].y * GRID_SIZE,
                 GRID_SIZE,
-                obstacles[i].length * GRID_SIZE
+                parking.obstacles[i].length * GRID_SIZE
             };
-            SDL_RenderFillRect(renderer, &obsRect);
+            countDrawCall(SDL_RenderFillRect(renderer, &obsRect));
         }
     }
 
     // Отрисовка разметки парковки (белые линии)
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
     for (int i = 0; i <= GRID_WIDTH; i++)
-        SDL_RenderDrawLine(renderer, LEFT_X+i*GRID_SIZE, LEFT_Y, LEFT_X+i*GRID_SIZE, LEFT_Y+GRID_HEIGHT*GRID_SIZE);
+        countDrawCall(SDL_RenderDrawLine(renderer, LEFT_X+i*GRID_SIZE, LEFT_Y, LEFT_X+i*GRID_SIZE, LEFT_Y+GRID_HEIGHT*GRID_SIZE));
     for (int i = 0; i <= GRID_HEIGHT; i++)
-        SDL_RenderDrawLine(renderer, LEFT_X, LEFT_Y+i*GRID_SIZE, LEFT_X+GRID_WIDTH*GRID_SIZE, LEFT_Y+i*GRID_SIZE);
+        countDrawCall(SDL_RenderDrawLine(renderer, LEFT_X, LEFT_Y+i*GRID_SIZE, LEFT_X+GRID_WIDTH*GRID_SIZE, LEFT_Y+i*GRID_SIZE));
 
     // Отрисовка выездов
     renderExits();
+}
 
-    // Отрисовка всех машин
-    for (int i = 0; i < carCount; i++) {
-        if (cars[i].exited) continue;
-
-        // Угол поворота в зависимости от направления
-        double angle = 0;
-        switch (cars[i].dir) {
-            case UP:    angle = 0; break;
-            case RIGHT: angle = 90; break;
-            case DOWN: angle = 180; break;
-            case LEFT: angle = 270; break;
-        }
+// Функция построения кэша поля (один раз на уровень)
+void bakeBoard() {
+    SDL_SetRenderTarget(renderer, boardTexture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    renderBoard();
+    SDL_SetRenderTarget(renderer, NULL);
+    boardDirty = false;
+}
 
-        // Центр поворота (середина текстуры)
-        SDL_Point center = {cars[i].drawRect.w/2, cars[i].drawRect.h/2};
-        
-        // Отрисовка с поворотом
-        SDL_RenderCopyEx(renderer, cars[i].texture, NULL, &cars[i].drawRect, 
-                        angle, &center, SDL_FLIP_NONE);
+// Функция отрисовки машин по одной: копия кадра атласа и отдельные рамки (--no-car-batch)
+void renderCarsOneByOne() {
+    for (int i = 0; i < parking.carCount; i++) {
+        if (parking.cars[i].exited) continue;
+
+        // Кадр атласа уже повернут по направлению машины
+        SDL_Rect drawRect = toSDLRect(calculateCarRect(parking.cars[i]));
+        drawCar(renderer, carSheet, drawRect, parking.cars[i].dir);
 
         // Выделение выбранной машины
-        if (cars[i].isSelected) {
+        if (&parking.cars[i] == selectedCar) {
             SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-            SDL_RenderDrawRect(renderer, &cars[i].drawRect);
+            countDrawCall(SDL_RenderDrawRect(renderer, &drawRect));
+        }
+
+        // Машина, которой нужно ходить по подсказке (рамка в две линии поверх выделения)
+        if (hintShown && shownHint.status == SOLVE_FOUND && shownHint.move.car == i) {
+            SDL_Rect inner = {drawRect.x + 2, drawRect.y + 2, drawRect.w - 4, drawRect.h - 4};
+            SDL_SetRenderDrawColor(renderer, 255, 220, 0, 255);
+            countDrawCall(SDL_RenderDrawRect(renderer, &drawRect));
+            countDrawCall(SDL_RenderDrawRect(renderer, &inner));
         }
     }
-    
+}
+
+// Функция отрисовки машин одним вызовом: машины и рамки в порядке номеров, как по одной
+void renderCarsBatched() {
+    SDL_Color red = {255, 0, 0, 255};
+    SDL_Color yellow = {255, 220, 0, 255};
+    carBatchClear(carBatch);
+    for (int i = 0; i < parking.carCount; i++) {
+        if (parking.cars[i].exited) continue;
+        SDL_Rect rect = toSDLRect(calculateCarRect(parking.cars[i]));
+        carBatchAddCar(carBatch, carSheet, rect, parking.cars[i].dir);
+        if (&parking.cars[i] == selectedCar) carBatchAddFrame(carBatch, carSheet, rect, red);
+        if (hintShown && shownHint.status == SOLVE_FOUND && shownHint.move.car == i) {
+            SDL_Rect inner = {rect.x + 2, rect.y + 2, rect.w - 4, rect.h - 4};
+            carBatchAddFrame(carBatch, carSheet, rect, yellow);
+            carBatchAddFrame(carBatch, carSheet, inner, yellow);
+        }
+    }
+    carBatchDraw(carBatch, renderer, carSheet);
+}
+
+// Функция отрисовки игрового поля
+void renderGame() {
+    // Неподвижная часть поля - одним копированием из кэша
+    if (boardTexture) {
+        if (boardDirty) bakeBoard();
+        countDrawCall(SDL_RenderCopy(renderer, boardTexture, NULL, NULL));
+    } else {
+        renderBoard();
+    }
+
+    // Отрисовка всех машин
+    if (useCarBatch) renderCarsBatched();
+    else renderCarsOneByOne();
 
     // Отображение информации о сложности и количестве ходов
     SDL_Color white = {255, 255, 255, 255};
-    std::string diffText = "Difficulty: " + std::to_string(difficulty);
-    std::string movesText = "Steps: " + std::to_string(moves);
-    
-    SDL_Texture* diffTexture = createTextTexture(diffText.c_str(), white);
-    SDL_Texture* movesTexture = createTextTexture(movesText.c_str(), white);
+    char diffText[32], movesText[32];
+    snprintf(diffText, sizeof(diffText), "Difficulty: %d", difficulty);
+    snprintf(movesText, sizeof(movesText), "Steps: %d", parking.moves);
     
     SDL_Rect diffRect = {20, 20, 150, 30};
     SDL_Rect movesRect = {20, 60, 100, 30};
     
-    SDL_RenderCopy(renderer, diffTexture, NULL, &diffRect);
-    SDL_RenderCopy(renderer, movesTexture, NULL, &movesRect);
-    
-    SDL_DestroyTexture(diffTexture);
-    SDL_DestroyTexture(movesTexture);
+    drawText(renderer, fontAtlas, diffText, white, diffRect);
+    drawText(renderer, fontAtlas, movesText, white, movesRect);
+
+    // Текст подсказки: действие и сколько ходов останется по найденному решению
+    if (hintShown || hintRequested) {
+        static const char* actionNames[4] = {"forward", "back", "turn left", "turn right"};
+        char hintText[64];
+        if (hintRequested) snprintf(hintText, sizeof(hintText), "Hint: thinking%.*s", (int)(gameTicks / 15 % 4), "...");
+        else if (shownHint.status == SOLVE_FOUND && shownHint.move.car >= 0)
+            snprintf(hintText, sizeof(hintText), "Hint: %s (%d%s to go)", actionNames[shownHint.move.action],
+                     shownHint.remaining, shownHint.optimal ? "" : "+");
+        else if (shownHint.status == SOLVE_UNSOLVABLE) snprintf(hintText, sizeof(hintText), "Hint: no way out");
+        else snprintf(hintText, sizeof(hintText), "Hint: too hard");
+        SDL_Color yellow = {255, 220, 0, 255};
+        SDL_Rect hintRect = {20, 100, 300, 30};
+        drawText(renderer, fontAtlas, hintText, yellow, hintRect);
+    }
+}
+
+// Функция расположения большой парковки по текущему размеру окна
+void layoutLot() {
+    int outW, outH;
+    SDL_GetRendererOutputSize(renderer, &outW, &outH);
+    layoutLotView(lotView, lot.get(), outW, outH, LOT_HUD_HEIGHT);
+}
+
+// Функция выбора системы координат: большая парковка рисуется в пикселях окна,
+// остальные экраны - в логических 800x600
+void updateLogicalSize() {
+    if (gameState == PLAYING && lot) {
+        SDL_RenderSetLogicalSize(renderer, 0, 0);
+        layoutLot();
+    } else {
+        SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+}
 
-    SDL_RenderPresent(renderer); // Обновление экрана
+// Функция отрисовки большой парковки: фон, два слоя поля и надписи
+void renderLotGame() {
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    countDrawCall(SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL));
+    renderLotView(lotView, renderer, carSheet, useCarBatch, exitTexture, selectedLotCar);
+
+    // Отображение оставшихся машин и количества ходов
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 128);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_Rect back = {10, 5, 420, 40};
+    countDrawCall(SDL_RenderFillRect(renderer, &back));
+
+    SDL_Color white = {255, 255, 255, 255};
+    char carsText[48], movesText[32];
+    snprintf(carsText, sizeof(carsText), "Cars left: %d/%d", lot->carCount() - lot->exitedCount(), lot->carCount());
+    snprintf(movesText, sizeof(movesText), "Steps: %d", lot->moves());
+    SDL_Rect carsRect = {20, 10, 12 * (int)strlen(carsText), 30};
+    SDL_Rect movesRect = {280, 10, 12 * (int)strlen(movesText), 30};
+    drawText(renderer, fontAtlas, carsText, white, carsRect);
+    drawText(renderer, fontAtlas, movesText, white, movesRect);
 }
 
 // Функция отрисовки экрана победы
 void renderWin() {
     // Отрисовка фона
-    SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
+    countDrawCall(SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL));
 
     //Отрисовка черного полупрозрачного прямоугольника
     SDL_SetRenderDrawColor(renderer, 0,0,0,128);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_Rect back = {200, 150, 400, 300};
-    SDL_RenderFillRect(renderer, &back);
+    countDrawCall(SDL_RenderFillRect(renderer, &back));
 
     // Отрисовка текста "ПОБЕДА!"
-    int winW, winH;
-    SDL_QueryTexture(winTexture, NULL, NULL, &winW, &winH);
-    SDL_Rect winRect = {SCREEN_WIDTH/2 - winW/2, 190, winW, winH};
-    SDL_RenderCopy(renderer, winTexture, NULL, &winRect);
+    SDL_Color yellow = {255, 255, 51, 255};
+    SDL_Rect winArea = {0, 190, SCREEN_WIDTH, fontBigAtlas.height};
+    drawTextCentered(renderer, fontBigAtlas, "WIN!", yellow, winArea);
 
     // Отрисовка информации о количестве ходов
     SDL_Color white = {255, 255, 255, 255};
-    std::string movesText = "Steps: " + std::to_string(moves);
-    SDL_Texture* movesTexture = createTextTexture(movesText.c_str(), white);
+    char movesText[32];
+    snprintf(movesText, sizeof(movesText), "Steps: %d", lot ? lot->moves() : parking.moves);
     
     SDL_Rect movesRect = {SCREEN_WIDTH/2 - 100, 280, 200, 30};
-    SDL_RenderCopy(renderer, movesTexture, NULL, &movesRect);
-    SDL_DestroyTexture(movesTexture);
+    drawText(renderer, fontAtlas, movesText, white, movesRect);
 
     // Отрисовка кнопки возврата в меню
     SDL_Rect menuButton = {SCREEN_WIDTH/2 - 100, 350, 200, 60};
     SDL_SetRenderDrawColor(renderer, 0, 0, 200, 255);
-    SDL_RenderFillRect(renderer, &menuButton);
+    countDrawCall(SDL_RenderFillRect(renderer, &menuButton));
     
-    SDL_Texture* menuText = createTextTexture("Menu", white);
-    int textW, textH;
-    SDL_QueryTexture(menuText, NULL, NULL, &textW, &textH);
-    SDL_Rect textRect = {
-        menuButton.x + (menuButton.w - textW)/2,
-        menuButton.y + (menuButton.h - textH)/2,
-        textW,
-        textH
-    };
-    SDL_RenderCopy(renderer, menuText, NULL, &textRect);
-    SDL_DestroyTexture(menuText);
+    drawTextCentered(renderer, fontAtlas, "Menu", white, menuButton);
+}
+
+// Функция отрисовки панели замеров: p50/p99 кадра и каждой его части, мс
+void renderTimingOverlay() {
+    int width = SCREEN_WIDTH;
+    if (gameState == PLAYING && lot) SDL_GetRendererOutputSize(renderer, &width, NULL); // Координаты в пикселях окна
+
+    const int lineHeight = 16, lines = PHASE_COUNT + 1 + (probeLatency ? 1 : 0);
+    SDL_Rect panel = {width - 250, 0, 250, lines * lineHeight + 8};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    countDrawCall(SDL_RenderFillRect(renderer, &panel));
+
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Color gray = {160, 160, 160, 255};
+    char text[64];
+    const RollingHistogram& frame = frameTiming.histogram(PHASE_FRAME);
+    snprintf(text, sizeof(text), "frame p50 %.2f p99 %.2f ms", frame.percentile(50) / 1000, frame.percentile(99) / 1000);
+    SDL_Rect line = {panel.x + 6, 4, panel.w - 12, lineHeight};
+    drawText(renderer, fontSmallAtlas, text, white, line);
+    for (int p = 0; p < PHASE_FRAME; p++) {
+        const RollingHistogram& h = frameTiming.histogram((FramePhase)p);
+        line.y += lineHeight;
+        snprintf(text, sizeof(text), "%s %.2f / %.2f", framePhaseName((FramePhase)p),
+                 h.percentile(50) / 1000, h.percentile(99) / 1000);
+        drawText(renderer, fontSmallAtlas, text, h.size() ? white : gray, line);
+    }
+    line.y += lineHeight;
+    if (frameScheduler.mode() == PACING_UNCAPPED) snprintf(text, sizeof(text), "pacing uncapped");
+    else snprintf(text, sizeof(text), "pacing %s %.0f fps", pacingModeName(frameScheduler.mode()), frameScheduler.fps());
+    drawText(renderer, fontSmallAtlas, text, gray, line);
+    if (probeLatency) {
+        const RollingHistogram& h = latencyProbe.recent();
+        line.y += lineHeight;
+        snprintf(text, sizeof(text), "input p50 %.0f p99 %.0f ms (%zu)", h.percentile(50) / 1000,
+                 h.percentile(99) / 1000, latencyProbe.samples());
+        drawText(renderer, fontSmallAtlas, text, white, line);
+    }
+}
 
-    SDL_RenderPresent(renderer); // Обновление экрана
+// Функция записи сводки замеров кадра
+void dumpFrameTiming() {
+    SDL_RendererInfo info;
+    const char* rendererName = SDL_GetRendererInfo(renderer, &info) == 0 ? info.name : "unknown";
+    if (frameTiming.writeCsv(frameCsvPath, BUILD_NAME, rendererName))
+        printf("Замеры кадра записаны в %s\n", frameCsvPath);
+    else
+        printf("Не удалось записать замеры кадра в %s\n", frameCsvPath);
+}
+
+// Функция начала записи партии: уровень восстанавливается по зерну и номеру кандидата
+void startReplay(ReplayBoard board, uint64_t seed, uint32_t attempt) {
+    ReplayHeader h;
+    h.board = board;
+    h.difficulty = difficulty;
+    h.width = board == REPLAY_LOT ? lotWidth : GRID_WIDTH;
+    h.height = board == REPLAY_LOT ? lotHeight : GRID_HEIGHT;
+    h.seed = seed;
+    h.attempt = attempt;
+    replayWriter.begin(h);
+    moveJournal.clear(); // Новая партия - ходы прежней не отменяются
+}
+
+// Функция конца записи партии с итогом и счетчиком ходов
+void finishReplay(ReplayResult result) {
+    replayWriter.end(result, lot ? lot->moves() : parking.moves);
+}
+
+// Функция выбора машины на парковке 8x8 (-1 - снять выделение)
+void selectCar(int car) {
+    selectedCar = car >= 0 ? &parking.cars[car] : NULL;
+}
+
+// Функция перехода к сгенерированному уровню (результат запроса из меню)
+void finishLevelRequest() {
+    GenerationStats stats;
+    bool inBand = false;
+    if (!levelGenerator->takeResult(parking, &stats, &inBand)) return;
+    if (inBand) {
+        const DifficultyMetrics& m = stats.metrics;
+        printf("Уровень (зерно %llu) сгенерирован за %.1f мс (первый подходящий за %.1f мс, %d попыток): "
+               "решение %d%s ходов, %d на пропуск машин, ветвление %.1f, тупиков %.0f%%\n",
+               (unsigned long long)levelSeed, stats.seconds * 1000, stats.firstSeconds * 1000, stats.attempts,
+               m.optimalMoves, m.optimal ? "" : "?", m.blockingMoves, m.branchingFactor,
+               m.deadEndRatio * 100);
+    } else if (stats.attempt >= 0) {
+        printf("Уровень (зерно %llu) нужной сложности не найден, взят решаемый (попытка %d из %d)\n",
+               (unsigned long long)levelSeed, stats.attempt, stats.attempts);
+    } else {
+        printf("Не удалось сгенерировать решаемый уровень за %d попыток\n", stats.attempts);
+        // Первый кандидат без проверки решаемости (тоже восстанавливается по зерну)
+        ParkingRng levelRng;
+        seedLevelRng(levelRng, levelSeed, 0);
+        generateParking(parking, difficulty, levelRng);
+        stats.attempt = 0;
+    }
+    startReplay(REPLAY_PARKING, levelSeed, (uint32_t)stats.attempt);
+    hintEngine->newLevel(parking); // Решатель начинает думать сразу, до нажатия H
+    selectedCar = NULL;  // Сброс выбранной машины
+    boardDirty = true;   // Новый уровень - новые препятствия
+    gameState = PLAYING; // Переход в игровой режим
 }
 
 // Функция обработки кликов мыши
 void handleClick(int x, int y) {
     switch (gameState) {
         case MENU:
+            if (levelGenerator->requestPending()) return; // Уровень уже генерируется
             // Обработка кликов по кнопкам сложности в меню
             for (int i = 0; i < 3; i++) {
                 SDL_Rect rect = {SCREEN_WIDTH/2 - 90, 220 + i*70, 180, 50};
                 if (x >= rect.x && x <= rect.x + rect.w && y >= rect.y && y <= rect.y + rect.h) {
                     difficulty = i + 1; // Установка сложности
-                    generateParking();   // Генерация парковки
-                    gameState = PLAYING; // Переход в игровой режим
+                    uint64_t seed = gameRng(); // Зерно уровня (по нему уровень можно получить снова)
+                    if (lotWidth) {
+                        // Большая парковка: генерация без проверки решаемости (решатель работает на 8x8)
+                        Uint64 start = SDL_GetPerformanceCounter();
+                        ParkingRng levelRng;
+                        seedLevelRng(levelRng, seed, 0);
+                        lot = createLot(lotWidth, lotHeight);
+                        lot->generate(difficulty, levelRng);
+                        startReplay(REPLAY_LOT, seed, 0);
+                        printf("Парковка %dx%d (зерно %llu) сгенерирована за %.1f мс (%d машин, %d препятствий)\n",
+                               lotWidth, lotHeight, (unsigned long long)seed,
+                               (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency(),
+                               lot->carCount(), lot->obstacleCount());
+                        destroyLotView(lotView); // Новая парковка - слои строятся заново
+                        selectedLotCar = -1;
+                        gameState = PLAYING;
+                        return;
+                    }
+                    // Генерация решаемой парковки, сложность которой по метрикам решателя попадает
+                    // в диапазон выбранного уровня сложности, идет в фоне: меню продолжает рисоваться,
+                    // уровень подставляется по событию levelEventType (finishLevelRequest)
+                    levelSeed = seed;
+                    levelGenerator->requestTargeted(difficulty, defaultBand(difficulty), seed, [] {
+                        SDL_Event ready = {};
+                        ready.type = levelEventType;
+                        SDL_PushEvent(&ready);
+                    });
+                    frameDirty = true;
                     return;
                 }
             }
             break;
             
         case PLAYING: {
+            if (lot) {
+                selectedLotCar = lotViewPick(lotView, x, y); // Машина под курсором через индекс клеток
+                return;
+            }
             // Проверка, что клик был внутри игрового поля
             if (x < LEFT_X || x >= LEFT_X + GRID_WIDTH*GRID_SIZE || y < LEFT_Y || y >= LEFT_Y + GRID_HEIGHT*GRID_SIZE)
                 return;
@@ -780,37 +782,8 @@ void handleClick(int x, int y) {
             int gx = (x - LEFT_X) / GRID_SIZE;
             int gy = (y - LEFT_Y) / GRID_SIZE;
             
-            // Сброс выделения всех машин
-            for (int i = 0; i < carCount; i++)
-                cars[i].isSelected = false;
-            selectedCar = NULL;
-            
-            // Поиск машины по координатам клика
-            for (int i = 0; i < carCount; i++) {
-                if (cars[i].exited) continue; // Пропуск выехавших машин
-                
-                if (cars[i].dir == UP || cars[i].dir == DOWN) {
-                    // Проверка вертикальных машин
-                    for (int j = 0; j < cars[i].length; j++) {
-                        int cy = cars[i].y + (cars[i].dir == DOWN ? j : -j);
-                        if (cars[i].x == gx && cy == gy) {
-                            cars[i].isSelected = true; // Выделение машины
-                            selectedCar = &cars[i];    // Установка выбранной машины
-                            return;
-                        }
-                    }
-                } else {
-                    // Проверка горизонтальных машин
-                    for (int j = 0; j < cars[i].length; j++) {
-                        int cx = cars[i].x + (cars[i].dir == RIGHT ? j : -j);
-                        if (cx == gx && cars[i].y == gy) {
-                            cars[i].isSelected = true; // Выделение машины
-                            selectedCar = &cars[i];    // Установка выбранной машины
-                            return;
-                        }
-                    }
-                }
-            }
+            // Выделение меняется только у прежней и новой машины
+            selectCar(carAtCell(parking, gx, gy)); // Машина под курсором через индекс клеток
             break;
         }
             
@@ -825,72 +798,406 @@ void handleClick(int x, int y) {
     }
 }
 
+// Функция перевода клавиши в действие над выбранной машиной (false - клавиша не управляет машиной)
+bool keyToAction(SDL_Keycode key, CarAction* action) {
+    switch (key) {
+        case SDLK_UP:    *action = MOVE_FORWARD;  return true; // Движение ВПЕРЕД (по направлению машины)
+        case SDLK_DOWN:  *action = MOVE_BACKWARD; return true; // Движение НАЗАД (против направления машины)
+        case SDLK_LEFT:  *action = TURN_LEFT;     return true; // Поворот налево
+        case SDLK_RIGHT: *action = TURN_RIGHT;    return true; // Поворот направо
+    }
+    return false;
+}
+
+// Функция отмены последнего хода или повтора отмененного (false - в журнале нет такого хода)
+bool stepJournal(bool redo) {
+    if (redo ? !moveJournal.canRedo() : !moveJournal.canUndo()) return false;
+    JournalEntry e = redo ? moveJournal.redo() : moveJournal.undo();
+    if (redo) replayWriter.redo(); // Отмена и повтор тоже попадают в запись партии
+    else replayWriter.undo();
+    if (lot) {
+        Car before = lot->car(e.car);
+        if (redo) lot->applyCarAction(e.car, e.action);
+        else lot->undoCarAction(e.car, e.action);
+        lotViewCarChanged(lotView, before, lot->car(e.car));
+    } else {
+        if (redo) applyCarAction(parking, &parking.cars[e.car], e.action);
+        else undoCarAction(parking, &parking.cars[e.car], e.action);
+    }
+    return true;
+}
+
+// Функция показа подсказки, если она запрошена и уже готова (поток решателя не ждем)
+void pollHint() {
+    Hint h;
+    if (!(hintRequested || hintShown) || !hintEngine->hint(&h)) return;
+    if (hintRequested) {
+        hintLatencies.push_back((SDL_GetPerformanceCounter() - hintRequestTime) * 1000.0 / SDL_GetPerformanceFrequency());
+        hintRequested = false;
+    }
+    shownHint = h; // Показанная подсказка могла уточниться до кратчайшей
+    hintShown = true;
+    frameDirty = true;
+}
+
+// Функция вывода задержек подсказок
+void printHintLatency() {
+    if (hintLatencies.empty()) return;
+    std::vector<double> t = hintLatencies;
+    std::sort(t.begin(), t.end());
+    printf("Подсказок: %zu, задержка p50 %.3f мс, p99 %.3f мс, max %.3f мс\n", t.size(), t[t.size() / 2],
+           t[std::min(t.size() - 1, t.size() * 99 / 100)], t.back());
+}
+
+// Функция анимируемого состояния: пока оно есть, кадры рисуются непрерывно в темпе планировщика,
+// иначе поток спит до следующего события
+bool animating() {
+    return showTimingOverlay || hintRequested || levelGenerator->requestPending();
+}
+
+// Функция одного шага обновления игры (вызывается с фиксированным шагом, не зависит от частоты кадров)
+void updateGame() {
+    gameTicks++;
+}
+
+// Функция выбора хода для синтетического нажатия: выбирает машину, которая может сдвинуться,
+// не выезжая с парковки (иначе партия закончится победой)
+bool pickInjectedMove(SDL_Keycode* key) {
+    static int nextCar = 0; // Машины перебираются по кругу, чтобы ходили разные
+    for (int n = 0; n < parking.carCount; n++) {
+        int i = (nextCar + n) % parking.carCount;
+        if (parking.cars[i].exited) continue;
+        for (int a = 0; a < 2; a++) {
+            CarAction action = a == 0 ? MOVE_FORWARD : MOVE_BACKWARD;
+            Parking next = parking;
+            if (!applyCarAction(next, &next.cars[i], action) || next.cars[i].exited) continue;
+            selectCar(i);
+            *key = action == MOVE_FORWARD ? SDLK_UP : SDLK_DOWN;
+            nextCar = i + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Функция синтетического ввода: нажатие проходит через очередь событий SDL, как настоящее.
+// Ход чередуется с его отменой, поэтому парковка не меняется и партия не заканчивается.
+void injectInput() {
+    if (levelGenerator->requestPending()) return; // Уровень еще генерируется
+    if (gameState == MENU) {
+        handleClick(SCREEN_WIDTH/2 - 90 + 1, 220 + 1); // Кнопка первой сложности
+        frameDirty = true;
+        return;
+    }
+    SDL_Event key = {};
+    key.type = SDL_KEYDOWN;
+    key.key.timestamp = SDL_GetTicks(); // SDL_PushEvent ставит ту же отметку
+    if (gameState == PLAYING && moveJournal.canUndo()) {
+        key.key.keysym.sym = SDLK_BACKSPACE;
+    } else if (gameState != PLAYING || !pickInjectedMove(&key.key.keysym.sym)) {
+        printf("Синтетический ввод остановлен: нет хода\n");
+        injectRemaining = 0;
+        return;
+    }
+    SDL_PushEvent(&key);
+    injectRemaining--;
+}
+
+// Функция обработки одного события (возвращает false при выходе из игры)
+bool handleEvent(const SDL_Event& e) {
+    GameState prevState = gameState;
+    Car* prevSelected = selectedCar;
+    int prevLotSelected = selectedLotCar;
+
+    if (e.type == SDL_QUIT) {
+        return false; // Выход из игры при закрытии окна
+    } else if (e.type == SDL_WINDOWEVENT) {
+        // Окно показано, развернуто или перекрыто - содержимое нужно нарисовать заново
+        switch (e.window.event) {
+            case SDL_WINDOWEVENT_RESIZED:
+            case SDL_WINDOWEVENT_SIZE_CHANGED:
+                if (gameState == PLAYING && lot) layoutLot(); // Клетка подбирается под новый размер
+                frameDirty = true;
+                break;
+            case SDL_WINDOWEVENT_SHOWN:
+            case SDL_WINDOWEVENT_EXPOSED:
+            case SDL_WINDOWEVENT_MAXIMIZED:
+            case SDL_WINDOWEVENT_RESTORED:
+                frameDirty = true;
+                break;
+        }
+    } else if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET) {
+        frameDirty = true; // Драйвер потерял содержимое текстур и экрана
+        boardDirty = true;
+        lotView.boardDirty = lotView.carsDirty = true;
+    } else if (e.type == hintEventType) {
+        pollHint(); // Решатель закончил поиск
+    } else if (e.type == levelEventType) {
+        finishLevelRequest(); // Уровень из меню готов
+    } else if (e.type == SDL_KEYDOWN && (e.key.keysym.sym == SDLK_F3 || e.key.keysym.sym == SDLK_F4)) {
+        if (e.key.keysym.sym == SDLK_F3) {
+            showTimingOverlay = !showTimingOverlay;
+            frameDirty = true;
+        } else {
+            dumpFrameTiming();
+        }
+    } else if (e.type == SDL_MOUSEBUTTONDOWN) {
+        // Обработка клика мыши (координаты события уже пересчитаны в логические 800x600)
+        PhaseScope scope(frameTiming, PHASE_CLICK);
+        handleClick(e.button.x, e.button.y);
+    } else if (e.type == SDL_KEYDOWN && gameState == PLAYING) {
+        // Обработка нажатий клавиш для управления выбранной машиной
+        CarAction action;
+        SDL_Keycode key = e.key.keysym.sym;
+        bool ctrl = (e.key.keysym.mod & KMOD_CTRL) != 0;
+        bool shift = (e.key.keysym.mod & KMOD_SHIFT) != 0;
+        bool undoKey = key == SDLK_BACKSPACE || (ctrl && key == SDLK_z && !shift);
+        bool redoKey = ctrl && (key == SDLK_y || (key == SDLK_z && shift));
+        if (probeLatency) latencyProbe.input(e.key.timestamp, SDL_GetTicks());
+        if (key == SDLK_q) {
+            finishReplay(REPLAY_ABANDONED);
+            gameState = MENU;
+        } else if (key == SDLK_h && !lot) {
+            if (!hintShown && !hintRequested) {
+                hintRequested = true;
+                hintRequestTime = SDL_GetPerformanceCounter();
+                frameDirty = true;
+                pollHint(); // Обычно подсказка уже готова
+            }
+        } else if (undoKey || redoKey || keyToAction(key, &action)) {
+            bool changed = false;
+            if (undoKey || redoKey) {
+                changed = stepJournal(redoKey);
+            } else if (lot && selectedLotCar >= 0) {
+                replayWriter.move(selectedLotCar, action); // Каждое нажатие попадает в запись партии
+                Car before = lot->car(selectedLotCar);
+                changed = lot->applyCarAction(selectedLotCar, action);
+                if (changed) {
+                    moveJournal.record(selectedLotCar, action);
+                    lotViewCarChanged(lotView, before, lot->car(selectedLotCar)); // Только клетки машины
+                }
+            } else if (!lot && selectedCar) {
+                int car = (int)(selectedCar - parking.cars);
+                replayWriter.move(car, action);
+                changed = applyCarAction(parking, selectedCar, action);
+                if (changed) moveJournal.record(car, action);
+            }
+            if (changed) {
+                frameDirty = true;
+                if (probeLatency) latencyProbe.reflected(); // Ход будет виден в следующем кадре
+                if (!lot) {
+                    hintEngine->setBoard(parking); // Решатель переключается на новую расстановку
+                    hintShown = false;
+                    pollHint();
+                }
+            }
+
+            // Проверка условия победы после каждого хода
+            if (changed && (lot ? lot->checkWin() : checkWin(parking))) {
+                finishReplay(REPLAY_WON);
+                gameState = WIN;
+            }
+        }
+    }
+
+    // Вне партии решателю думать не над чем
+    if (gameState != prevState && gameState != PLAYING) {
+        hintEngine->cancel();
+        hintRequested = hintShown = false;
+    }
+
+    // Смена экрана или выбранной машины тоже требует перерисовки
+    if (gameState != prevState || selectedCar != prevSelected || selectedLotCar != prevLotSelected) frameDirty = true;
+    if (gameState != prevState) updateLogicalSize();
+    return true;
+}
+
 // Главная функция программы
 int main(int argc, char* argv[]) {
+    startTime = std::chrono::steady_clock::now();
+    uint64_t startSeed = (uint64_t)time(0); // Зерно генератора зерен уровней (--seed N - повторить игру)
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--no-board-cache")) useBoardCache = false;
+        else if (!strcmp(argv[i], "--no-car-batch")) useCarBatch = false;
+        else if (!strcmp(argv[i], "--asset-pack") && i + 1 < argc) assetPackPath = argv[++i];
+        else if (!strcmp(argv[i], "--no-asset-pack")) useAssetPack = false;
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) startSeed = strtoull(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc) replayPath = argv[++i];
+        else if (!strcmp(argv[i], "--no-replay")) replayPath = NULL;
+        else if (!strcmp(argv[i], "--frame-csv") && i + 1 < argc) {
+            frameCsvPath = argv[++i];
+            frameCsvOnExit = true;
+        }
+        else if (!strcmp(argv[i], "--vsync")) pacingMode = PACING_VSYNC;
+        else if (!strcmp(argv[i], "--uncapped")) pacingMode = PACING_UNCAPPED;
+        else if (!strcmp(argv[i], "--fps") && i + 1 < argc) {
+            // Заданная частота кадров без vsync, например --fps 144
+            targetFps = atof(argv[++i]);
+            if (targetFps <= 0) {
+                printf("Неверная частота кадров %s\n", argv[i]);
+                return 1;
+            }
+            pacingMode = PACING_TARGET_FPS;
+        }
+        else if (!strcmp(argv[i], "--latency")) probeLatency = true;
+        else if (!strcmp(argv[i], "--latency-csv") && i + 1 < argc) {
+            latencyCsvPath = argv[++i];
+            probeLatency = true;
+        }
+        else if (!strcmp(argv[i], "--latency-inject") && i + 1 < argc) {
+            injectTotal = injectRemaining = atoi(argv[++i]);
+            probeLatency = true;
+            replayPath = NULL; // Синтетические ходы не попадают в файл партий
+        }
+        else if (!strcmp(argv[i], "--lot") && i + 1 < argc) {
+            // Размер большой парковки, например --lot 64x64
+            if (sscanf(argv[++i], "%dx%d", &lotWidth, &lotHeight) != 2 || !createLot(lotWidth, lotHeight)) {
+                printf("Неверный размер парковки %s (от %d до %d по каждой стороне)\n", argv[i],
+                       MIN_LOT_SIZE, MAX_LOT_SIZE);
+                return 1;
+            }
+        }
+    }
+    if (injectTotal > 0 && lotWidth) {
+        printf("Синтетический ввод работает только на парковке 8x8\n");
+        return 1;
+    }
+    lotView.useLayers = useBoardCache; // Без кэша большая парковка рисуется целиком в каждом кадре
+    gameRng.seed(startSeed); // Инициализация генератора случайных чисел
+    printf("Зерно игры: %llu\n", (unsigned long long)startSeed);
+
     if (!initSDL()) return 1; // Инициализация SDL, выход при ошибке
+    if (replayPath && !replayWriter.open(replayPath))
+        printf("Не удалось открыть файл партий %s, партии не записываются\n", replayPath);
+    levelGenerator = new LevelGenerator(); // Потоки генерации запускаются один раз
+    hintEngine = new HintEngine();
+    hintEventType = SDL_RegisterEvents(2);
+    if (hintEventType != (Uint32)-1) levelEventType = hintEventType + 1;
+    hintEngine->setReadyCallback([] {
+        // SDL_PushEvent можно вызывать из любого потока
+        SDL_Event ready = {};
+        ready.type = hintEventType;
+        SDL_PushEvent(&ready);
+    });
 
     bool running = true;  // Флаг работы главного цикла
     SDL_Event e;          // Структура для хранения событий
     
     // Главный игровой цикл
     while (running) {
-        bool chit = false;
-        // Обработка событий
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) {
-                running = false; // Выход из игры при закрытии окна
-            } else if (e.type == SDL_MOUSEBUTTONDOWN) {
-                // Обработка клика мыши
-                int x, y;
-                SDL_GetMouseState(&x, &y);
-                handleClick(x, y);
-            } else if (e.type == SDL_KEYDOWN && gameState == PLAYING && selectedCar) {
-                // Обработка нажатий клавиш для управления выбранной машиной
-                switch (e.key.keysym.sym) {
-                        case SDLK_UP:  // Движение ВПЕРЕД (по направлению машины)
-                            switch (selectedCar->dir) {
-                                case UP:    moveCar(selectedCar, 0, -1); break;  // Движение вверх
-                                case DOWN:  moveCar(selectedCar, 0, 1); break;   // Движение вниз
-                                case LEFT:  moveCar(selectedCar, -1, 0); break;  // Движение влево
-                                case RIGHT: moveCar(selectedCar, 1, 0); break;   // Движение вправо
-                            }
-                            break;
-
-                        case SDLK_DOWN:  // Движение НАЗАД (против направления машины)
-                            switch (selectedCar->dir) {
-                                case UP:    moveCar(selectedCar, 0, 1); break;   // Назад (вниз)
-                                case DOWN:  moveCar(selectedCar, 0, -1); break;  // Назад (вверх)
-                                case LEFT:  moveCar(selectedCar, 1, 0); break;   // Назад (вправо)
-                                case RIGHT: moveCar(selectedCar, -1, 0); break;  // Назад (влево)
-                            }
-                            break;
-                        case SDLK_LEFT: 
-                            rotateCar(selectedCar, true);  // Поворот налево
-                            break;
-                        case SDLK_RIGHT: 
-                            rotateCar(selectedCar, false);  // Поворот направо
-                            break;
-                        case SDLK_q: 
-                            chit = true; 
-                            break;
-                    }
-                
-                // Проверка условия победы после каждого хода
-                if (checkWin()) gameState = WIN;
-                if (chit) gameState = MENU;
+        // Синтетическое нажатие, когда прежнее уже на экране
+        if (injectRemaining > 0 && !latencyProbe.pending() && (Sint32)(SDL_GetTicks() - nextInjectTicks) >= 0) {
+            injectInput();
+            nextInjectTicks = SDL_GetTicks() + INJECT_INTERVAL_MS;
+        }
+
+        // Если на экране ничего не изменилось и ничего не анимируется, поток спит до следующего события
+        if (!frameDirty && !animating()) {
+            bool got;
+            {
+                PhaseScope scope(frameTiming, PHASE_WAIT);
+                if (injectRemaining > 0) {
+                    // Поток просыпается к следующему синтетическому нажатию
+                    Sint32 wait = (Sint32)(nextInjectTicks - SDL_GetTicks());
+                    got = SDL_WaitEventTimeout(&e, wait > 1 ? wait : 1);
+                } else {
+                    got = SDL_WaitEvent(&e);
+                }
             }
+            frameScheduler.resume(); // Время простоя не догоняется шагами обновления
+            PhaseScope scope(frameTiming, PHASE_LOGIC);
+            if (got && !handleEvent(e)) running = false;
+        }
+        // Обработка накопившихся событий
+        while (running) {
+            bool got;
+            {
+                PhaseScope scope(frameTiming, PHASE_EVENTS);
+                got = SDL_PollEvent(&e);
+            }
+            if (!got) break;
+            PhaseScope scope(frameTiming, PHASE_LOGIC);
+            if (!handleEvent(e)) running = false;
+        }
+        // Синтетический ввод закончен, последнее нажатие уже на экране
+        if (injectTotal > 0 && injectRemaining == 0 && !latencyProbe.pending()) running = false;
+        if (!running) break;
+
+        // Шаги обновления с фиксированным шагом: сколько накопилось с прошлого кадра
+        {
+            PhaseScope scope(frameTiming, PHASE_UPDATE);
+            for (int steps = frameScheduler.beginFrame(); steps > 0; steps--) updateGame();
+        }
+        if (animating()) frameDirty = true;
+        if (!frameDirty) {
+            frameTiming.endFrame(false);
+            continue;
         }
         
         // Отрисовка текущего состояния игры
+        drawCallCount = 0;
         switch (gameState) {
-            case MENU: renderMenu(); break;
-            case PLAYING: renderGame(); break;
-            case WIN: renderWin(); break;
+            case MENU: {
+                PhaseScope scope(frameTiming, PHASE_RENDER_MENU);
+                renderMenu();
+                break;
+            }
+            case PLAYING: {
+                PhaseScope scope(frameTiming, lot ? PHASE_RENDER_LOT : PHASE_RENDER_GAME);
+                if (lot) renderLotGame();
+                else renderGame();
+                gameFrames++;
+                gameDrawCalls += drawCallCount;
+                break;
+            }
+            case WIN: {
+                PhaseScope scope(frameTiming, PHASE_RENDER_WIN);
+                renderWin();
+                break;
+            }
+        }
+        if (showTimingOverlay) {
+            PhaseScope scope(frameTiming, PHASE_OVERLAY);
+            renderTimingOverlay();
+        }
+        {
+            PhaseScope scope(frameTiming, PHASE_PRESENT);
+            SDL_RenderPresent(renderer); // Обновление экрана
+        }
+        if (probeLatency) latencyProbe.presented(SDL_GetTicks());
+        frameDirty = false;
+        if (!startupReported) {
+            // Сравнение путей запуска: assets.pack и --no-asset-pack
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+            printf("Запуск: первый кадр через %.1f мс, текстуры %.1f мс (%s)\n", ms, assetLoadMs,
+                   assetsFromPack ? "пакет" : "изображения");
+            startupReported = true;
         }
         
-        SDL_Delay(16); // Небольшая задержка для снижения нагрузки на CPU
+        {
+            PhaseScope scope(frameTiming, PHASE_DELAY);
+            frameScheduler.endFrame(); // Сон только на остаток бюджета кадра
+        }
+        frameTiming.endFrame(true);
     }
     
+    if (gameFrames > 0) {
+        printf("Кадров игры: %lld, вызовов отрисовки на кадр: %.1f (кэш поля %s)\n", gameFrames,
+               (double)gameDrawCalls / gameFrames, boardTexture ? "включен" : "выключен");
+    }
+
+    printHintLatency();
+    if (frameCsvOnExit) dumpFrameTiming();
+    if (probeLatency) {
+        latencyProbe.printSummary();
+        if (latencyCsvPath && !latencyProbe.writeCsv(latencyCsvPath))
+            printf("Не удалось записать замеры задержки в %s\n", latencyCsvPath);
+    }
+
+    if (gameState == PLAYING) finishReplay(REPLAY_ABANDONED); // Выход посреди партии
+    replayWriter.close();
+    delete hintEngine;     // Остановка решателя подсказок
+    delete levelGenerator; // Остановка потоков генерации
     closeSDL(); // Освобождение ресурсов перед выходом
     return 0;
 }
\ No newline at end of file
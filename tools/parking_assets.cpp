@@ -0,0 +1,101 @@
+// Сборка пакета текстур для быстрого запуска игры (шаг сборки parking_game, см. game/asset_pack.h)
+//
+//   parking_assets -o assets.pack [-d каталог_изображений] [-f ARGB8888|ABGR8888|RGBA8888|BGRA8888]
+//
+// Формат по умолчанию ARGB8888 - первый формат текстур у рендереров OpenGL, Direct3D, Metal и
+// программного; если рендерер его не принимает, игра загружает исходные изображения.
+#include "asset_pack.h"
+#include "car_batch.h"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const Uint32 formats[] = {SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGBA8888,
+                                 SDL_PIXELFORMAT_BGRA8888};
+
+// Функция поиска формата по имени без префикса SDL_PIXELFORMAT_
+static Uint32 parseFormat(const char* name) {
+    for (Uint32 f : formats)
+        if (!strcmp(SDL_GetPixelFormatName(f) + strlen("SDL_PIXELFORMAT_"), name)) return f;
+    return SDL_PIXELFORMAT_UNKNOWN;
+}
+
+// Функция загрузки изображения; flags - как у SDL_CreateTextureFromSurface: прозрачность только
+// у изображений с альфа-каналом или цветовым ключом
+static SDL_Surface* loadImage(const std::string& path, uint32_t* flags) {
+    SDL_Surface* surface = IMG_Load(path.c_str());
+    if (!surface) {
+        printf("Не удалось загрузить изображение %s! Ошибка: %s\n", path.c_str(), IMG_GetError());
+        return NULL;
+    }
+    *flags = SDL_ISPIXELFORMAT_ALPHA(surface->format->format) || SDL_HasColorKey(surface) ? ASSET_BLEND : 0;
+    return surface;
+}
+
+// Функция перевода поверхности в формат пакета (исходная освобождается)
+static SDL_Surface* convert(SDL_Surface* surface, Uint32 format) {
+    if (!surface) return NULL;
+    SDL_Surface* out = SDL_ConvertSurfaceFormat(surface, format, 0);
+    SDL_FreeSurface(surface);
+    if (!out) printf("Не удалось преобразовать изображение! Ошибка: %s\n", SDL_GetError());
+    return out;
+}
+
+static void printUsage() {
+    printf("usage: parking_assets -o FILE [-d ASSETS_DIR] [-f ARGB8888|ABGR8888|RGBA8888|BGRA8888]\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* outPath = NULL;
+    std::string dir = "assets";
+    Uint32 format = SDL_PIXELFORMAT_ARGB8888;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "-o") && hasValue) outPath = argv[++i];
+        else if (!strcmp(argv[i], "-d") && hasValue) dir = argv[++i];
+        else if (!strcmp(argv[i], "-f") && hasValue) format = parseFormat(argv[++i]);
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (!outPath || format == SDL_PIXELFORMAT_UNKNOWN) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<AssetImage> images;
+    uint32_t flags = 0;
+    SDL_Surface* background = convert(loadImage(dir + "/background.png", &flags), format);
+    if (background) images.push_back({"background", background, flags, background->w, background->h});
+    SDL_Surface* exitImage = convert(loadImage(dir + "/exit.png", &flags), format);
+    if (exitImage) images.push_back({"exit", exitImage, flags, exitImage->w, exitImage->h});
+
+    // Машина: в пакет попадает готовый атлас с кадром на каждое направление
+    SDL_Surface* car = loadImage(dir + "/car.png", &flags);
+    if (car) {
+        CarSheet layout;
+        layoutCarSheet(layout, car->w, car->h);
+        SDL_Surface* sheet = convert(buildCarSheetSurface(layout, car), format);
+        if (sheet) images.push_back({"car_sheet", sheet, ASSET_BLEND, car->w, car->h});
+        SDL_FreeSurface(car);
+    }
+
+    bool ok = images.size() == 3 && writeAssetPack(outPath, format, images);
+    size_t bytes = 0;
+    for (const AssetImage& img : images) {
+        bytes += (size_t)img.surface->w * img.surface->h * SDL_BYTESPERPIXEL(format);
+        SDL_FreeSurface(img.surface);
+    }
+    if (!ok) {
+        printf("Не удалось собрать пакет текстур %s\n", outPath);
+        remove(outPath); // Недописанный пакет не должен попасть в игру
+        return 1;
+    }
+    printf("%s: %zu images, %zu KB, %s\n", outPath, images.size(), bytes / 1024, SDL_GetPixelFormatName(format));
+    return 0;
+}
@@ -0,0 +1,1055 @@
+// Бенчмарк игровой логики без окна: горячие функции, решатель, генерация уровней и подсказки
+//
+//   parking_bench [--csv | --json] [--micro]
+//   --csv/--json - результаты в машиночитаемом виде в stdout (текстовый отчет уходит в stderr)
+//   --micro      - только замеры горячих функций (без долгих замеров решателя и генерации)
+#include "parking.h"
+#include "solver.h"
+#include "level_generator.h"
+#include "lot.h"
+#include "move_journal.h"
+#include "hint_engine.h"
+#include "perf_counters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Один результат замера
+struct BenchResult {
+    std::string name;   // Замеряемая функция
+    int difficulty;     // Сложность досок
+    double nsPerOp;     // Среднее время одного вызова
+    uint64_t ops;       // Сколько вызовов замерено
+};
+
+static std::vector<BenchResult> results;
+static FILE* info = stdout;          // Текстовый отчет
+static volatile uint64_t benchSink;  // Не даем компилятору выбросить замеряемые циклы
+
+static void addResult(const char* name, int difficulty, double nsPerOp, uint64_t ops) {
+    results.push_back({name, difficulty, nsPerOp, ops});
+    fprintf(info, "  %-22s %10.2f ns/op  (%llu ops)\n", name, nsPerOp, (unsigned long long)ops);
+}
+
+// Прежняя проверка клетки перебором выездов, препятствий и машин (эталон для бенчмарка)
+static bool isCellFreeScan(const Parking& p, int x, int y) {
+    if (isExitCell(x, y)) return true;
+    if (!inGrid(x, y)) return false;
+
+    for (int i = 0; i < p.obstacleCount; i++) {
+        const Obstacle& o = p.obstacles[i];
+        if (o.isHorizontal) {
+            if (y == o.y && x >= o.x && x < o.x + o.length)
+                return false;
+        } else {
+            if (x == o.x && y >= o.y && y < o.y + o.length)
+                return false;
+        }
+    }
+
+    for (int i = 0; i < p.carCount; i++) {
+        if (p.cars[i].exited) continue;
+        for (int j = 0; j < p.cars[i].length; j++) {
+            int cx, cy;
+            carCell(p.cars[i], j, &cx, &cy);
+            if (cx == x && cy == y) return false;
+        }
+    }
+    return true;
+}
+
+// Прежняя проверка хода машины через поклеточный перебор (эталон для бенчмарка)
+static bool canMoveScan(const Parking& p, const Car* car, int dx, int dy) {
+    if (car->exited) return false;
+
+    for (int i = 0; i < car->length; i++) {
+        int cx, cy;
+        carCell(*car, i, &cx, &cy);
+        cx += dx;
+        cy += dy;
+
+        if (isExitCell(cx, cy)) continue;
+        if (!isCellFreeScan(p, cx, cy)) {
+            bool isOurCar = false;
+            for (int j = 0; j < car->length; j++) {
+                int ox, oy;
+                carCell(*car, j, &ox, &oy);
+                if (ox == cx && oy == cy) {
+                    isOurCar = true;
+                    break;
+                }
+            }
+            if (!isOurCar) return false;
+        }
+    }
+    return true;
+}
+
+// Прежний выбор машины мышью: перебор клеток всех машин (эталон для бенчмарка)
+static int carAtCellScan(const Parking& p, int gx, int gy) {
+    for (int i = 0; i < p.carCount; i++) {
+        if (p.cars[i].exited) continue;
+        for (int j = 0; j < p.cars[i].length; j++) {
+            int cx, cy;
+            carCell(p.cars[i], j, &cx, &cy);
+            if (cx == gx && cy == gy) return i;
+        }
+    }
+    return -1;
+}
+
+// Эталон наибольшего числа машин длины 2 на свободных клетках (не препятствия и не выезды):
+// наибольшее паросочетание соседних клеток, рекурсивный алгоритм Куна от клеток с четной x + y
+static bool augmentReference(int u, const bool* freeCell, int* mate, bool* seen) {
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (const auto& d : dirs) {
+        int x = u % GRID_WIDTH + d[0], y = u / GRID_WIDTH + d[1];
+        if (!inGrid(x, y)) continue;
+        int v = y * GRID_WIDTH + x;
+        if (!freeCell[v] || seen[v]) continue;
+        seen[v] = true;
+        if (mate[v] < 0 || augmentReference(mate[v], freeCell, mate, seen)) {
+            mate[v] = u;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int maxCarsReference(const Parking& p) {
+    bool freeCell[GRID_WIDTH * GRID_HEIGHT];
+    int mate[GRID_WIDTH * GRID_HEIGHT];
+    for (int i = 0; i < GRID_WIDTH * GRID_HEIGHT; i++) {
+        int x = i % GRID_WIDTH, y = i / GRID_WIDTH;
+        freeCell[i] = !isExitCell(x, y) && !(p.obstacleMask & cellBit(x, y));
+        mate[i] = -1;
+    }
+    int matched = 0;
+    for (int u = 0; u < GRID_WIDTH * GRID_HEIGHT; u++) {
+        if (!freeCell[u] || (u % GRID_WIDTH + u / GRID_WIDTH) % 2 != 0) continue;
+        bool seen[GRID_WIDTH * GRID_HEIGHT] = {};
+        matched += augmentReference(u, freeCell, mate, seen);
+    }
+    return matched;
+}
+
+// Функция проверки индекса клеток по перебору: число клеток с разным ответом
+static int pickMismatches(const Parking& p) {
+    int n = 0;
+    for (int y = 0; y < GRID_HEIGHT; y++)
+        for (int x = 0; x < GRID_WIDTH; x++)
+            if (carAtCell(p, x, y) != carAtCellScan(p, x, y)) n++;
+    return n;
+}
+
+// Функция замера: batch выполняет порцию вызовов и возвращает их число.
+// Порции повторяются, пока замер не займет хотя бы 50 мс.
+template <typename Batch>
+static void measure(const char* name, int difficulty, Batch batch) {
+    batch(); // Прогрев
+    uint64_t ops = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        ops += batch();
+        elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 50e6);
+    addResult(name, difficulty, elapsed / (ops ? ops : 1), ops);
+}
+
+// Замер горячих функций игровой логики на досках с фиксированным зерном
+static int runMicroBenchmark() {
+    const int dirs[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    static Parking parking, work;
+    int mismatches = 0;
+
+    for (int d = 1; d <= 3; d++) {
+        ParkingRng boardRng(42 + d);
+        generateParking(parking, d, boardRng);
+        fprintf(info, "difficulty %d: cars %d, obstacles %d\n", d, parking.carCount, parking.obstacleCount);
+
+        // Проверка, что битовая карта дает тот же ответ, что и прежний перебор
+        for (int y = -2; y < GRID_HEIGHT + 2; y++)
+            for (int x = -2; x < GRID_WIDTH + 2; x++)
+                if (isCellFree(parking, x, y) != isCellFreeScan(parking, x, y)) mismatches++;
+        for (int i = 0; i < parking.carCount; i++)
+            for (int k = 0; k < 4; k++)
+                if (canMove(parking, &parking.cars[i], dirs[k][0], dirs[k][1]) !=
+                    canMoveScan(parking, &parking.cars[i], dirs[k][0], dirs[k][1])) mismatches++;
+        mismatches += pickMismatches(parking);
+
+        // Все клетки парковки с рамкой в одну клетку
+        measure("isCellFree", d, [&] {
+            uint64_t n = 0, sink = 0;
+            for (int y = -1; y <= GRID_HEIGHT; y++)
+                for (int x = -1; x <= GRID_WIDTH; x++, n++)
+                    sink += isCellFree(parking, x, y);
+            benchSink = sink;
+            return n;
+        });
+        measure("isCellFree_scan", d, [&] {
+            uint64_t n = 0, sink = 0;
+            for (int y = -1; y <= GRID_HEIGHT; y++)
+                for (int x = -1; x <= GRID_WIDTH; x++, n++)
+                    sink += isCellFreeScan(parking, x, y);
+            benchSink = sink;
+            return n;
+        });
+
+        // Все машины во всех четырех направлениях
+        measure("canMove", d, [&] {
+            uint64_t n = 0, sink = 0;
+            for (int i = 0; i < parking.carCount; i++)
+                for (int k = 0; k < 4; k++, n++)
+                    sink += canMove(parking, &parking.cars[i], dirs[k][0], dirs[k][1]);
+            benchSink = sink;
+            return n;
+        });
+        measure("canMove_scan", d, [&] {
+            uint64_t n = 0, sink = 0;
+            for (int i = 0; i < parking.carCount; i++)
+                for (int k = 0; k < 4; k++, n++)
+                    sink += canMoveScan(parking, &parking.cars[i], dirs[k][0], dirs[k][1]);
+            benchSink = sink;
+            return n;
+        });
+
+        // Выбор машины мышью во всех клетках парковки: индекс клеток и прежний перебор
+        measure("pickCar", d, [&] {
+            uint64_t sink = 0;
+            for (int y = 0; y < GRID_HEIGHT; y++)
+                for (int x = 0; x < GRID_WIDTH; x++) sink += carAtCell(parking, x, y);
+            benchSink = sink;
+            return (uint64_t)(GRID_WIDTH * GRID_HEIGHT);
+        });
+        measure("pickCar_scan", d, [&] {
+            uint64_t sink = 0;
+            for (int y = 0; y < GRID_HEIGHT; y++)
+                for (int x = 0; x < GRID_WIDTH; x++) sink += carAtCellScan(parking, x, y);
+            benchSink = sink;
+            return (uint64_t)(GRID_WIDTH * GRID_HEIGHT);
+        });
+
+        // Ходы туда и обратно, после которых доска возвращается в исходное состояние
+        struct Step { int car, dx, dy; };
+        std::vector<Step> steps;
+        work = parking;
+        for (int i = 0; i < work.carCount; i++)
+            for (int k = 0; k < 4; k++) {
+                if (!moveCar(work, &work.cars[i], dirs[k][0], dirs[k][1])) continue;
+                bool back = !work.cars[i].exited && moveCar(work, &work.cars[i], -dirs[k][0], -dirs[k][1]);
+                if (!back) {
+                    // Машина выехала: восстанавливаем доску целиком
+                    work = parking;
+                    continue;
+                }
+                steps.push_back({i, dirs[k][0], dirs[k][1]});
+            }
+        work = parking;
+        measure("moveCar", d, [&] {
+            uint64_t sink = 0;
+            for (const Step& st : steps) {
+                sink += moveCar(work, &work.cars[st.car], st.dx, st.dy);
+                sink += moveCar(work, &work.cars[st.car], -st.dx, -st.dy);
+            }
+            benchSink = sink;
+            return (uint64_t)steps.size() * 2;
+        });
+
+        // Поворот налево и обратно направо
+        work = parking;
+        measure("rotateCar", d, [&] {
+            for (int i = 0; i < work.carCount; i++) {
+                rotateCar(work, &work.cars[i], true);
+                rotateCar(work, &work.cars[i], false);
+            }
+            benchSink = work.carMask;
+            return (uint64_t)work.carCount * 2;
+        });
+
+        // Худший случай: выехали все машины, кроме последней
+        work = parking;
+        for (int i = 0; i + 1 < work.carCount; i++) work.cars[i].exited = true;
+        measure("checkWin", d, [&] {
+            uint64_t sink = 0;
+            for (int r = 0; r < 64; r++) sink += checkWin(work);
+            benchSink = sink;
+            return (uint64_t)64;
+        });
+
+        measure("calculateCarRect", d, [&] {
+            uint64_t sink = 0;
+            for (int i = 0; i < parking.carCount; i++) sink += calculateCarRect(parking.cars[i]).x;
+            benchSink = sink;
+            return (uint64_t)parking.carCount;
+        });
+
+        ParkingRng genRng(7000 + d);
+        measure("generateObstacles", d, [&] {
+            generateObstacles(work, d, genRng);
+            benchSink = work.obstacleMask;
+            return (uint64_t)1;
+        });
+        measure("generateParking", d, [&] {
+            generateParking(work, d, genRng);
+            benchSink = work.carMask;
+            return (uint64_t)1;
+        });
+    }
+
+    // Генератор случайных чисел и его инициализация на каждую попытку LevelGenerator;
+    // для сравнения - прежний std::mt19937 с инициализацией через std::seed_seq
+    ParkingRng rng(1);
+    measure("rng.next", 0, [&] {
+        uint64_t sink = 0;
+        for (int i = 0; i < 1000; i++) sink += rng();
+        benchSink = sink;
+        return (uint64_t)1000;
+    });
+    measure("rng.randomInt", 0, [&] {
+        uint64_t sink = 0;
+        for (int i = 0; i < 1000; i++) sink += randomInt(rng, 7);
+        benchSink = sink;
+        return (uint64_t)1000;
+    });
+    std::mt19937 mt(1);
+    measure("rng.next_mt19937", 0, [&] {
+        uint64_t sink = 0;
+        for (int i = 0; i < 1000; i++) sink += mt();
+        benchSink = sink;
+        return (uint64_t)1000;
+    });
+    uint64_t attempt = 0;
+    measure("seedLevelRng", 0, [&] {
+        for (int i = 0; i < 100; i++) seedLevelRng(rng, 42, attempt++);
+        benchSink = rng();
+        return (uint64_t)100;
+    });
+    measure("seedLevelRng_mt19937", 0, [&] {
+        for (int i = 0; i < 100; i++, attempt++) {
+            std::seed_seq seq{42u, 0u, (uint32_t)attempt, (uint32_t)(attempt >> 32)};
+            mt.seed(seq);
+        }
+        benchSink = mt();
+        return (uint64_t)100;
+    });
+
+    // Расстановка: машин меньше запрошенного, только если больше не помещается ни при какой
+    // расстановке (эталон - наибольшее паросочетание), и ни одна машина не пересекает другую
+    for (int d = 1; d <= 3; d++) {
+        static Parking board;
+        ParkingRng placeRng(300 + d);
+        int requested = std::min(MAX_CARS, (10 + (d - 1) * 5) * GRID_WIDTH * GRID_HEIGHT / 64);
+        int boards = 5000, shortBoards = 0;
+        uint64_t placed = 0, possible = 0;
+        for (int b = 0; b < boards; b++) {
+            generateParking(board, d, placeRng);
+            placed += board.carCount;
+            int best = std::min(requested, maxCarsReference(board));
+            possible += best;
+            if (board.carCount != best) mismatches++;
+            for (int c : board.carCellCount) mismatches += c > 1;
+            for (int i = 0; i < board.carCount; i++)
+                for (int j = 0; j < board.cars[i].length; j++) {
+                    int cx, cy;
+                    carCell(board.cars[i], j, &cx, &cy);
+                    if (!inGrid(cx, cy) || isExitCell(cx, cy) || (board.obstacleMask & cellBit(cx, cy))) mismatches++;
+                }
+            if (board.carCount >= requested) continue;
+            shortBoards++;
+            for (int y = 0; y < GRID_HEIGHT; y++)
+                for (int x = 0; x < GRID_WIDTH; x++)
+                    for (int dir = 0; dir < 4; dir++) {
+                        Car probe = {};
+                        probe.x = x;
+                        probe.y = y;
+                        probe.dir = (Direction)dir;
+                        probe.length = 2;
+                        bool fits = true;
+                        for (int j = 0; j < probe.length; j++) {
+                            int cx, cy;
+                            carCell(probe, j, &cx, &cy);
+                            fits &= inGrid(cx, cy) && !isExitCell(cx, cy) && isCellFree(board, cx, cy);
+                        }
+                        if (fits) mismatches++;
+                    }
+        }
+        fprintf(info, "placement difficulty %d: %.2f of %d cars on average (maximum possible %.2f), "
+                "%d of %d boards full before the count\n",
+                d, (double)placed / boards, requested, (double)possible / boards, shortBoards, boards);
+    }
+
+    // Уровень полностью задается зерном и номером попытки
+    ParkingRng a, b;
+    seedLevelRng(a, 5, 3);
+    seedLevelRng(b, 5, 3);
+    generateParking(parking, 2, a);
+    generateParking(work, 2, b);
+    if (parking.carMask != work.carMask || parking.obstacleMask != work.obstacleMask) mismatches++;
+
+    // Журнал ходов: после отмены всех случайных ходов доска совпадает с исходной,
+    // после повтора всех - с доской до отмены
+    const int JOURNAL_STEPS = 10000;
+    for (int d = 1; d <= 3; d++) {
+        ParkingRng boardRng(500 + d), playerRng(600 + d);
+        generateParking(parking, d, boardRng);
+        work = parking;
+        MoveJournal journal(JOURNAL_STEPS);
+        for (int i = 0; i < JOURNAL_STEPS; i++) {
+            int car = randomInt(playerRng, work.carCount);
+            CarAction action = (CarAction)randomInt(playerRng, 4);
+            if (applyCarAction(work, &work.cars[car], action)) journal.record(car, action);
+            if (i % 100 == 0) mismatches += pickMismatches(work); // Повороты дают и перекрытия машин
+        }
+        static Parking played;
+        played = work;
+        int recorded = journal.undoCount();
+        while (journal.canUndo()) {
+            JournalEntry e = journal.undo();
+            undoCarAction(work, &work.cars[e.car], e.action);
+        }
+        if (memcmp(&work, &parking, sizeof(Parking)) != 0) mismatches++;
+        while (journal.canRedo()) {
+            JournalEntry e = journal.redo();
+            if (!applyCarAction(work, &work.cars[e.car], e.action)) mismatches++;
+        }
+        if (memcmp(&work, &played, sizeof(Parking)) != 0) mismatches++;
+        fprintf(info, "journal difficulty %d: %d of %d steps recorded, %zu bytes (snapshot of cars[]: %zu bytes per step)\n",
+                d, recorded, JOURNAL_STEPS, journal.memoryBytes(), sizeof(parking.cars));
+
+        // Отмена и повтор последних ходов на сыгранной доске
+        measure("undo+redo", d, [&] {
+            for (int i = 0; i < 100; i++) {
+                JournalEntry e = journal.undo();
+                undoCarAction(work, &work.cars[e.car], e.action);
+                e = journal.redo();
+                applyCarAction(work, &work.cars[e.car], e.action);
+            }
+            benchSink = work.carMask;
+            return (uint64_t)200;
+        });
+    }
+
+    fprintf(info, "mismatches: %d\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Функция сравнения выбора машины мышью на Parking (carAtCell) и через LotBase::carsAt
+// (lotViewPick): одни и те же случайные ходы с отменами, которые переставляют машины в
+// списках клеток; в клетке с несколькими машинами оба пути должны дать наименьший номер
+static int lotPickMismatches(Parking& parking, LotBase& lot, uint64_t seed) {
+    const int STEPS = 5000;
+    ParkingRng rng(seed);
+    MoveJournal journal(STEPS);
+    int mismatches = 0, overlapped = 0;
+    for (int step = 0; step < STEPS; step++) {
+        if (randomInt(rng, 4) == 0 && journal.canUndo()) {
+            JournalEntry e = journal.undo();
+            undoCarAction(parking, &parking.cars[e.car], e.action);
+            lot.undoCarAction(e.car, e.action);
+        } else {
+            int car = randomInt(rng, parking.carCount);
+            CarAction action = (CarAction)randomInt(rng, 4);
+            bool applied = applyCarAction(parking, &parking.cars[car], action);
+            if (applied != lot.applyCarAction(car, action)) mismatches++;
+            if (applied) journal.record(car, action);
+        }
+        for (int y = 0; y < GRID_HEIGHT; y++)
+            for (int x = 0; x < GRID_WIDTH; x++) {
+                int cars[MAX_CARS_IN_CELL];
+                int n = lot.carsAt(x, y, cars, MAX_CARS_IN_CELL);
+                int lotPick = n > 0 ? cars[0] : -1;
+                overlapped += n > 1;
+                if (lotPick != carAtCell(parking, x, y) || lotPick != carAtCellScan(parking, x, y)) mismatches++;
+            }
+    }
+
+    // Перекрытие вручную: машина с наименьшим номером убрана из клетки и возвращена последней
+    static Parking overlap;
+    overlap = Parking();
+    overlap.carCount = 3;
+    for (int i = 0; i < 3; i++) overlap.cars[i] = {3, 3, 2, (Direction)i, false};
+    for (int i = 0; i < 3; i++) addCarToMask(overlap, i);
+    removeCarFromMask(overlap, 0);
+    addCarToMask(overlap, 0);
+    if (carAtCell(overlap, 3, 3) != 0 || carAtCellScan(overlap, 3, 3) != 0) mismatches++;
+
+    fprintf(info, "pick consistency: %d overlapping cells compared, mismatches %d\n", overlapped, mismatches);
+    return mismatches;
+}
+
+// Замер правил на парковках разных размеров через выбор варианта во время работы
+static int runLotBenchmark() {
+    const int dirs[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    const int sizes[] = {8, 10, 16};
+    static Parking parking;
+    int mismatches = 0;
+
+    for (int size : sizes) {
+        std::unique_ptr<LotBase> lot = createLot(size, size);
+        if (!lot) {
+            mismatches++;
+            continue;
+        }
+        for (int d = 1; d <= 3; d++) {
+            ParkingRng rng(42 + d);
+            lot->generate(d, rng);
+            fprintf(info, "lot %dx%d difficulty %d: cars %d, obstacles %d\n", size, size, d,
+                    lot->carCount(), lot->obstacleCount());
+
+            // Парковка 8x8 через общий интерфейс должна совпадать с Parking
+            if (size == GRID_WIDTH) {
+                ParkingRng same(42 + d);
+                generateParking(parking, d, same);
+                if (parking.carCount != lot->carCount()) mismatches++;
+                for (int i = 0; i < parking.carCount && i < lot->carCount(); i++)
+                    for (int k = 0; k < 4; k++)
+                        if (canMove(parking, &parking.cars[i], dirs[k][0], dirs[k][1]) !=
+                            lot->canMove(i, dirs[k][0], dirs[k][1])) mismatches++;
+                mismatches += lotPickMismatches(parking, *lot, 300 + d);
+            }
+
+            char name[64];
+            snprintf(name, sizeof(name), "lot%dx%d.isCellFree", size, size);
+            measure(name, d, [&] {
+                uint64_t n = 0, sink = 0;
+                for (int y = -1; y <= size; y++)
+                    for (int x = -1; x <= size; x++, n++)
+                        sink += lot->isCellFree(x, y);
+                benchSink = sink;
+                return n;
+            });
+            snprintf(name, sizeof(name), "lot%dx%d.canMove", size, size);
+            measure(name, d, [&] {
+                uint64_t n = 0, sink = 0;
+                for (int i = 0; i < lot->carCount(); i++)
+                    for (int k = 0; k < 4; k++, n++)
+                        sink += lot->canMove(i, dirs[k][0], dirs[k][1]);
+                benchSink = sink;
+                return n;
+            });
+            snprintf(name, sizeof(name), "lot%dx%d.generate", size, size);
+            ParkingRng genRng(7000 + d);
+            std::unique_ptr<LotBase> scratch = createLot(size, size);
+            measure(name, d, [&] {
+                scratch->generate(d, genRng);
+                benchSink = scratch->carCount();
+                return (uint64_t)1;
+            });
+        }
+    }
+
+    fprintf(info, "lot mismatches: %d\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Масштабирование по размеру парковки: стоимость хода и проверки победы не должна расти с числом машин
+static int runLotScalingBenchmark() {
+    const int sizes[] = {8, 16, 24, 32, 48, 64};
+    const int ACTIONS = 200000;
+    int mismatches = 0;
+
+    for (int size : sizes) {
+        std::unique_ptr<LotBase> lot = createLot(size, size);
+        ParkingRng rng(900 + size);
+        auto t0 = std::chrono::steady_clock::now();
+        lot->generate(1, rng);
+        auto t1 = std::chrono::steady_clock::now();
+        fprintf(info, "lot %dx%d (%s): cars %d, obstacles %d, generate %.3f ms\n", size, size,
+                lot->compiled() ? "compiled" : "dynamic", lot->carCount(), lot->obstacleCount(),
+                std::chrono::duration<double, std::milli>(t1 - t0).count());
+
+        // Замер на случайных машинах парами действий, возвращающими парковку в исходное состояние:
+        // доля выехавших машин не меняется, и размеры сравниваются на одинаковой работе
+        std::vector<uint32_t> script(ACTIONS);
+        for (uint32_t& a : script) a = (uint32_t)rng();
+        int cars = lot->carCount();
+        char name[64];
+        snprintf(name, sizeof(name), "scale%dx%d.applyCarAction", size, size);
+        size_t pos = 0;
+        measure(name, 1, [&] {
+            uint64_t sink = 0;
+            for (int i = 0; i < 500; i++, pos = (pos + 1) % script.size()) {
+                int car = (int)(script[pos] % cars);
+                sink += lot->applyCarAction(car, TURN_LEFT);
+                sink += lot->applyCarAction(car, TURN_RIGHT);
+            }
+            benchSink = sink;
+            return (uint64_t)1000;
+        });
+        snprintf(name, sizeof(name), "scale%dx%d.canMove", size, size);
+        measure(name, 1, [&] {
+            uint64_t sink = 0;
+            for (int i = 0; i < 1000; i++, pos = (pos + 1) % script.size()) {
+                uint32_t a = script[pos];
+                sink += lot->canMove((int)(a % cars), (a >> 16) & 1 ? 1 : -1, 0);
+            }
+            benchSink = sink;
+            return (uint64_t)1000;
+        });
+        snprintf(name, sizeof(name), "scale%dx%d.checkWin", size, size);
+        measure(name, 1, [&] {
+            uint64_t sink = 0;
+            for (int i = 0; i < 64; i++) sink += lot->checkWin();
+            benchSink = sink;
+            return (uint64_t)64;
+        });
+
+        // Проверка индекса машин по клеткам (вместе с рамкой выездов) и счетчика выехавших;
+        // возвращает число занятых клеток рамки
+        auto checkIndex = [&] {
+            int exited = 0, border = 0;
+            for (int i = 0; i < cars; i++) exited += lot->car(i).exited;
+            if (exited != lot->exitedCount()) mismatches++;
+            for (int y = -BOARD_MARGIN; y < size + BOARD_MARGIN; y++)
+                for (int x = -BOARD_MARGIN; x < size + BOARD_MARGIN; x++) {
+                    int found[MAX_CARS_IN_CELL];
+                    int n = lot->carsAt(x, y, found, MAX_CARS_IN_CELL);
+                    int expected = 0;
+                    for (int i = 0; i < cars; i++) {
+                        const Car& c = lot->car(i);
+                        if (c.exited) continue;
+                        for (int j = 0; j < c.length; j++) {
+                            int cx, cy;
+                            carCell(c, j, &cx, &cy);
+                            if (cx == x && cy == y) expected++;
+                        }
+                    }
+                    if (n != expected) mismatches++;
+                    if (n > 0 && (x < 0 || x >= size || y < 0 || y >= size)) border++;
+                    for (int k = 1; k < n; k++)
+                        if (found[k - 1] >= found[k]) mismatches++; // Порядок номеров (выбор - младшая)
+                    for (int k = 0; k < n; k++) {
+                        const Car& c = lot->car(found[k]);
+                        bool covers = false;
+                        for (int j = 0; j < c.length; j++) {
+                            int cx, cy;
+                            carCell(c, j, &cx, &cy);
+                            covers |= cx == x && cy == y;
+                        }
+                        if (!covers) mismatches++;
+                    }
+                }
+            return border;
+        };
+
+        // Случайные ходы (без замера) через журнал, проверка индекса после них и после отмены всех
+        std::vector<Car> before(lot->carCount());
+        for (int i = 0; i < cars; i++) before[i] = lot->car(i);
+        int movesBefore = lot->moves();
+        MoveJournal journal(ACTIONS);
+        for (uint32_t a : script) {
+            int car = (int)(a % cars);
+            CarAction action = (CarAction)((a >> 16) & 3);
+            if (lot->applyCarAction(car, action)) journal.record(car, action);
+        }
+        int border = checkIndex();
+
+        // Клетки рамки, видимые на экране (выбор мышью и перерисовка выезжающих машин)
+        std::vector<Point> ring;
+        for (int i = -1; i <= size; i++) {
+            ring.push_back({i, -1});
+            ring.push_back({i, size});
+            if (i >= 0 && i < size) {
+                ring.push_back({-1, i});
+                ring.push_back({size, i});
+            }
+        }
+        snprintf(name, sizeof(name), "scale%dx%d.carsAtBorder", size, size);
+        measure(name, 1, [&] {
+            uint64_t sink = 0;
+            for (const Point& c : ring) {
+                int found[MAX_CARS_IN_CELL];
+                sink += lot->carsAt(c.x, c.y, found, MAX_CARS_IN_CELL);
+            }
+            benchSink = sink;
+            return (uint64_t)ring.size();
+        });
+        fprintf(info, "lot %dx%d: %d occupied border cells after random moves\n", size, size, border);
+        while (journal.canUndo()) {
+            JournalEntry e = journal.undo();
+            lot->undoCarAction(e.car, e.action);
+        }
+        checkIndex();
+        if (lot->moves() != movesBefore) mismatches++;
+        for (int i = 0; i < cars; i++) {
+            const Car& c = lot->car(i);
+            if (c.x != before[i].x || c.y != before[i].y || c.dir != before[i].dir || c.exited != before[i].exited)
+                mismatches++;
+        }
+    }
+
+    fprintf(info, "lot scaling mismatches: %d\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Функция вывода источника счетчиков: без PMU числа тактов и промахов нет, есть только время
+static void printPerfSource(const PerfCounters& perf) {
+    switch (perf.source()) {
+        case PERF_SOURCE_PMU:
+            fprintf(info, "perf: hardware counters (perf_event_open)\n");
+            break;
+        case PERF_SOURCE_SOFTWARE:
+            fprintf(info, "perf: hardware counters unavailable, only software task-clock (perf_event_open)\n");
+            break;
+        case PERF_SOURCE_WALL_CLOCK:
+            fprintf(info, "perf: perf_event_open unavailable, falling back to wall-clock estimates\n");
+            break;
+    }
+}
+
+// Функция вывода счетчиков процессора в пересчете на одну единицу работы (unit)
+static void printPerf(const PerfCounters& perf, const char* unit, uint64_t count) {
+    if (count == 0) return;
+    const double n = (double)count;
+    if (perf.source() == PERF_SOURCE_WALL_CLOCK) {
+        fprintf(info, "  perf per %s (estimate): wall-clock ns %.2f\n", unit, perf.wallNs() / n);
+        return;
+    }
+    const PerfEvent events[] = {PERF_CYCLES, PERF_INSTRUCTIONS, PERF_L1D_MISSES, PERF_CACHE_MISSES, PERF_TASK_CLOCK};
+    const char* names[] = {"cycles", "instructions", "L1d misses", "LLC misses", "task-clock ns"};
+    fprintf(info, "  perf per %s (%s):", unit, perf.source() == PERF_SOURCE_PMU ? "PMU" : "software");
+    for (int k = 0; k < 5; k++) {
+        if (perf.available(events[k])) fprintf(info, " %s %.2f", names[k], perf.value(events[k]) / n);
+        else fprintf(info, " %s n/a", names[k]);
+        if (events[k] == PERF_INSTRUCTIONS && perf.available(PERF_CYCLES) && perf.value(PERF_CYCLES) > 0)
+            fprintf(info, " (IPC %.2f)", (double)perf.value(PERF_INSTRUCTIONS) / perf.value(PERF_CYCLES));
+        fprintf(info, k + 1 < 5 ? "," : "\n");
+    }
+}
+
+// Замер решателя на досках с фиксированным зерном: узлы, память и время по каждой сложности
+static int runSolverBenchmark() {
+    const int BOARDS = 20;
+    static Parking parking, replay;
+    PerfCounters perf;
+    int failures = 0;
+
+    // Решатель и генератор читают только массив машин: чем он плотнее, тем меньше строк кэша
+    fprintf(info, "layout: Car %zu bytes, cars %zu bytes, Parking %zu bytes\n", sizeof(Car),
+            sizeof(parking.cars), sizeof(Parking));
+    printPerfSource(perf);
+
+    for (int d = 1; d <= 3; d++) {
+        ParkingRng rng(1000 + d);
+        perf.clear();
+        int solved = 0, optimal = 0, unsolvable = 0, limited = 0;
+        uint64_t expanded = 0, stored = 0, totalMoves = 0;
+        size_t peakMemory = 0;
+        double seconds = 0, worst = 0;
+
+        for (int b = 0; b < BOARDS; b++) {
+            generateParking(parking, d, rng);
+            perf.start();
+            SolveResult r = solveParking(parking);
+            perf.stop();
+            expanded += r.stats.expanded;
+            stored += r.stats.stored;
+            seconds += r.stats.seconds;
+            if (r.stats.seconds > worst) worst = r.stats.seconds;
+            if (r.stats.memoryBytes > peakMemory) peakMemory = r.stats.memoryBytes;
+
+            if (r.status == SOLVE_FOUND) {
+                solved++;
+                optimal += r.optimal;
+                totalMoves += r.moves.size();
+                // Проверка решения обычными игровыми функциями
+                replay = parking;
+                for (const SolverMove& m : r.moves)
+                    if (!applyCarAction(replay, &replay.cars[m.car], m.action)) failures++;
+                if (!checkWin(replay)) failures++;
+            } else if (r.status == SOLVE_UNSOLVABLE) {
+                unsolvable++;
+            } else {
+                limited++;
+            }
+        }
+
+        fprintf(info, "solver difficulty %d: %d boards, solved %d (proven optimal %d), unsolvable %d, limit %d\n",
+               d, BOARDS, solved, optimal, unsolvable, limited);
+        fprintf(info, "  avg %.3f ms, worst %.3f ms, avg moves %.1f, avg expanded %llu, avg stored %llu, peak memory %zu KB, %.0f nodes/s\n",
+               seconds * 1000 / BOARDS, worst * 1000, solved ? (double)totalMoves / solved : 0.0,
+               (unsigned long long)(expanded / BOARDS), (unsigned long long)(stored / BOARDS),
+               peakMemory / 1024, seconds > 0 ? expanded / seconds : 0.0);
+        printPerf(perf, "expanded node", expanded);
+        addResult("solveParking", d, seconds * 1e9 / BOARDS, BOARDS);
+    }
+
+    fprintf(info, "solver replay failures: %d\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+// Замер генерации решаемых уровней на пуле потоков (бюджет кадра 16 мс)
+static int runGenerationBenchmark() {
+    const int LEVELS = 50;
+    static Parking parking, again;
+    PerfCounters perf; // Открываются до пула потоков, чтобы считать и его потоки
+    LevelGenerator generator;
+    int failures = 0;
+
+    fprintf(info, "generation threads: %d\n", generator.threadCount());
+    for (int d = 1; d <= 3; d++) {
+        std::vector<double> times;
+        long long attempts = 0;
+        perf.clear();
+        for (int i = 0; i < LEVELS; i++) {
+            uint64_t seed = 5000 + i;
+            GenerationStats stats;
+            perf.start();
+            bool generated = generator.generateSolvable(parking, d, seed, &stats);
+            perf.stop();
+            if (!generated) {
+                failures++;
+                continue;
+            }
+            times.push_back(stats.seconds * 1000);
+            attempts += stats.attempts;
+
+            // Одно и то же зерно должно давать одну и ту же парковку
+            generator.generateSolvable(again, d, seed);
+            if (again.carCount != parking.carCount || again.obstacleMask != parking.obstacleMask ||
+                again.carMask != parking.carMask) failures++;
+            if (solveParking(parking, SOLVABILITY_NODE_LIMIT, false).status != SOLVE_FOUND) failures++;
+        }
+        if (times.empty()) continue;
+
+        std::sort(times.begin(), times.end());
+        double sum = 0;
+        for (double t : times) sum += t;
+        double p99 = times[std::min(times.size() - 1, times.size() * 99 / 100)];
+        int overBudget = (int)(times.end() - std::upper_bound(times.begin(), times.end(), 16.0));
+        fprintf(info, "generation difficulty %d: %zu levels, avg %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms, "
+               "over 16 ms %d, avg attempts %.1f\n",
+               d, times.size(), sum / times.size(), times[times.size() / 2], p99, times.back(),
+               overBudget, (double)attempts / times.size());
+        printPerf(perf, "attempt", (uint64_t)attempts);
+        addResult("generateSolvable", d, sum * 1e6 / times.size(), times.size());
+    }
+
+    // Уровни с метриками решателя в диапазоне сложности: время до первого подходящего кандидата
+    // и до выбора детерминированного результата, метрики выбранных уровней
+    for (int d = 1; d <= 3; d++) {
+        DifficultyBand band = defaultBand(d);
+        std::vector<double> first, times;
+        long long attempts = 0;
+        double moves = 0, blocking = 0, branching = 0, deadEnd = 0;
+        for (int i = 0; i < LEVELS; i++) {
+            uint64_t seed = 6000 + i;
+            GenerationStats stats;
+            if (!generator.generateTargeted(parking, d, band, seed, &stats)) {
+                failures++;
+                continue;
+            }
+            first.push_back(stats.firstSeconds * 1000);
+            times.push_back(stats.seconds * 1000);
+            attempts += stats.attempts;
+            moves += stats.metrics.optimalMoves;
+            blocking += stats.metrics.blockingMoves;
+            branching += stats.metrics.branchingFactor;
+            deadEnd += stats.metrics.deadEndRatio;
+
+            // Метрики выбранного уровня пересчитываются заново и попадают в диапазон
+            if (!band.contains(measureDifficulty(parking, METRICS_NODE_LIMIT))) failures++;
+            generator.generateTargeted(again, d, band, seed);
+            if (again.carMask != parking.carMask || again.obstacleMask != parking.obstacleMask) failures++;
+        }
+        if (times.empty()) continue;
+
+        std::sort(first.begin(), first.end());
+        std::sort(times.begin(), times.end());
+        size_t n = times.size();
+        fprintf(info, "targeted difficulty %d: %zu levels, first acceptable p50 %.2f ms, p99 %.2f ms; "
+               "result p50 %.2f ms, p99 %.2f ms; avg attempts %.1f\n",
+               d, n, first[n / 2], first[std::min(n - 1, n * 99 / 100)], times[n / 2],
+               times[std::min(n - 1, n * 99 / 100)], (double)attempts / n);
+        fprintf(info, "  avg moves %.1f, blocking %.2f, branching %.1f, dead ends %.2f\n",
+               moves / n, blocking / n, branching / n, deadEnd / n);
+        addResult("generateTargeted.first_p99", d, first[std::min(n - 1, n * 99 / 100)] * 1e6, n);
+        addResult("generateTargeted.p50", d, times[n / 2] * 1e6, n);
+        addResult("generateTargeted.p99", d, times[std::min(n - 1, n * 99 / 100)] * 1e6, n);
+    }
+
+    // Запрос уровня из меню: главный поток платит только за вызов requestTargeted, уровень приходит
+    // из потока запроса. Каждый второй запрос с лимитом в одну попытку, чтобы проверить переход
+    // к решаемому уровню того же зерна при промахе диапазона.
+    for (int d = 1; d <= 3; d++) {
+        const int REQUESTS = 20;
+        DifficultyBand band = defaultBand(d);
+        std::vector<double> call, ready; // мкс, мс
+        int fallbacks = 0;
+        for (int i = 0; i < REQUESTS; i++) {
+            uint64_t seed = 6000 + i;
+            int maxAttempts = i % 2 ? 1 : DEFAULT_GENERATION_ATTEMPTS;
+            std::atomic<bool> done{false};
+            auto start = std::chrono::steady_clock::now();
+            generator.requestTargeted(d, band, seed, [&] { done.store(true); }, maxAttempts);
+            call.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            while (!done.load()) std::this_thread::sleep_for(std::chrono::microseconds(100));
+            ready.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+            GenerationStats stats;
+            bool inBand = false;
+            if (!generator.takeResult(parking, &stats, &inBand) || stats.attempt < 0) {
+                failures++;
+                continue;
+            }
+            // Тот же уровень, что и у синхронной генерации с тем же исходом
+            bool same = inBand ? generator.generateTargeted(again, d, band, seed, nullptr, maxAttempts)
+                               : generator.generateSolvable(again, d, seed);
+            if (!same || again.carMask != parking.carMask || again.obstacleMask != parking.obstacleMask) failures++;
+            if (!inBand) {
+                fallbacks++;
+                if (solveParking(parking, SOLVABILITY_NODE_LIMIT, false).status != SOLVE_FOUND) failures++;
+            }
+        }
+        std::sort(call.begin(), call.end());
+        std::sort(ready.begin(), ready.end());
+        fprintf(info, "targeted request difficulty %d: call p50 %.1f us, max %.1f us; ready p50 %.2f ms, max %.2f ms; "
+               "band missed %d of %d\n", d, call[call.size() / 2], call.back(), ready[ready.size() / 2], ready.back(),
+               fallbacks, REQUESTS);
+        addResult("requestTargeted.call_max", d, call.back() * 1e3, REQUESTS);
+    }
+
+    // Достижимость диапазонов: на скольких зернах подряд generateTargeted не находит уровня за лимит
+    // попыток (тогда игра берет решаемый уровень того же зерна) и насколько далеко приходится искать
+    for (int d = 1; d <= 3; d++) {
+        const int SEEDS = 100;
+        DifficultyBand band = defaultBand(d);
+        int misses = 0, farthest = 0;
+        for (int i = 0; i < SEEDS; i++) {
+            GenerationStats stats;
+            if (!generator.generateTargeted(parking, d, band, 8000 + i, &stats)) misses++;
+            else farthest = std::max(farthest, stats.attempt);
+        }
+        fprintf(info, "targeted reach difficulty %d: band missed on %d of %d seeds, farthest chosen attempt %d of %d\n",
+                d, misses, SEEDS, farthest, DEFAULT_GENERATION_ATTEMPTS);
+    }
+
+    fprintf(info, "generation failures: %d\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+// Замер подсказок: игрок ходит то по подсказке, то случайно, подсказку просит сразу после хода
+// (думать некогда - худший случай), а иногда делает несколько ходов подряд, не дожидаясь ее
+static int runHintBenchmark() {
+    const int LEVELS = 10, STEPS = 60;
+    static Parking parking;
+    LevelGenerator generator;
+    HintEngine engine;
+    int failures = 0;
+
+    for (int d = 1; d <= 3; d++) {
+        std::vector<double> latency, setCost; // мс, мкс
+        int optimalHints = 0;
+        ParkingRng playerRng(1200 + d);
+        uint64_t hitsBefore = engine.cacheHits(), solvesBefore = engine.solves(), cancelledBefore = engine.cancelled();
+        for (int level = 0; level < LEVELS; level++) {
+            if (!generator.generateSolvable(parking, d, 7000 + level)) continue;
+            engine.newLevel(parking);
+
+            Hint prev;
+            bool followed = false;
+            for (int step = 0; step < STEPS && !checkWin(parking); step++) {
+                Hint h;
+                bool waited = randomInt(playerRng, 10) < 7;
+                if (waited) {
+                    auto t0 = std::chrono::steady_clock::now();
+                    if (!engine.waitHint(&h, 30.0)) {
+                        failures++;
+                        break;
+                    }
+                    latency.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+                    optimalHints += h.optimal;
+                    // После хода по кратчайшему решению до победы остается на ход меньше
+                    if (followed && prev.optimal && h.optimal && h.remaining != prev.remaining - 1) failures++;
+                }
+
+                followed = waited && h.status == SOLVE_FOUND && h.move.car >= 0 && randomInt(playerRng, 4) != 0;
+                if (followed) {
+                    if (!applyCarAction(parking, &parking.cars[h.move.car], h.move.action)) failures++;
+                    prev = h;
+                } else {
+                    // Случайный ход, меняющий расстановку
+                    for (int tries = 0; tries < 16; tries++) {
+                        int car = randomInt(playerRng, parking.carCount);
+                        if (applyCarAction(parking, &parking.cars[car], (CarAction)randomInt(playerRng, 4))) break;
+                    }
+                }
+
+                auto t0 = std::chrono::steady_clock::now();
+                engine.setBoard(parking);
+                setCost.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+            }
+        }
+        if (latency.empty()) continue;
+
+        std::sort(latency.begin(), latency.end());
+        std::sort(setCost.begin(), setCost.end());
+        double p99 = latency[std::min(latency.size() - 1, latency.size() * 99 / 100)];
+        double setP99 = setCost[std::min(setCost.size() - 1, setCost.size() * 99 / 100)];
+        fprintf(info, "hints difficulty %d: %zu requests (%d already optimal), latency p50 %.3f ms, p99 %.3f ms, "
+               "max %.3f ms; setBoard p99 %.1f us; cache hits %llu, solves %llu, cancelled %llu\n",
+               d, latency.size(), optimalHints, latency[latency.size() / 2], p99, latency.back(), setP99,
+               (unsigned long long)(engine.cacheHits() - hitsBefore), (unsigned long long)(engine.solves() - solvesBefore),
+               (unsigned long long)(engine.cancelled() - cancelledBefore));
+        addResult("hint.latency_p99", d, p99 * 1e6, latency.size());
+        addResult("hint.setBoard_p99", d, setP99 * 1e3, setCost.size());
+    }
+
+    fprintf(info, "hint failures: %d\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+// Функция вывода результатов в CSV
+static void printCsv() {
+    printf("name,difficulty,ns_per_op,ops\n");
+    for (const BenchResult& r : results)
+        printf("%s,%d,%.3f,%llu\n", r.name.c_str(), r.difficulty, r.nsPerOp, (unsigned long long)r.ops);
+}
+
+// Функция вывода результатов в JSON
+static void printJson() {
+    printf("{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        printf("    {\"name\": \"%s\", \"difficulty\": %d, \"ns_per_op\": %.3f, \"ops\": %llu}%s\n",
+               r.name.c_str(), r.difficulty, r.nsPerOp, (unsigned long long)r.ops,
+               i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+int main(int argc, char* argv[]) {
+    bool csv = false, json = false, microOnly = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--csv")) csv = true;
+        else if (!strcmp(argv[i], "--json")) json = true;
+        else if (!strcmp(argv[i], "--micro")) microOnly = true;
+        else {
+            printf("usage: parking_bench [--csv | --json] [--micro]\n");
+            return 1;
+        }
+    }
+    if (csv || json) info = stderr;
+
+    int rc = runMicroBenchmark();
+    rc |= runLotBenchmark();
+    rc |= runLotScalingBenchmark();
+    if (!microOnly) {
+        rc |= runSolverBenchmark();
+        rc |= runGenerationBenchmark();
+        rc |= runHintBenchmark();
+    }
+
+    if (csv) printCsv();
+    else if (json) printJson();
+    return rc;
+}
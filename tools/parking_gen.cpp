@@ -0,0 +1,254 @@
+// Пакетная генерация уровней в упакованный файл
+//
+//   parking_gen -o levels.pack [-d сложность] [-s первое_зерно] [-n число] [-t потоки]
+//   parking_gen --verify levels.pack     проверка файла повторной генерацией
+//   parking_gen --scaling [-n число]     скорость генерации на 1..N потоках без записи
+#include "parking.h"
+#include "level_generator.h"
+#include "level_pack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const uint64_t CHUNK_LEVELS = 4096;  // Уровней в одной порции потока
+
+// Порция уровней, сгенерированная одним потоком
+struct Chunk {
+    std::vector<uint8_t> bytes;
+    bool ready = false;
+};
+
+// Общее состояние генерации: потоки берут порции по порядку, запись идет строго по зернам
+struct GenJob {
+    int difficulty;
+    uint64_t firstSeed;
+    uint64_t count;
+    uint64_t chunkCount;
+    int window;                      // Порций в памяти одновременно
+    std::vector<Chunk> slots;        // Кольцо из window порций
+    uint64_t nextChunk = 0;          // Следующая порция для генерации
+    uint64_t written = 0;            // Порций уже записано
+    std::mutex mutex;
+    std::condition_variable readyCv; // Порция готова к записи
+    std::condition_variable freeCv;  // Освободилось место в кольце
+};
+
+// Функция генерации одного уровня по зерну (та же парковка, что первый кандидат LevelGenerator)
+static void generateLevel(Parking& p, int difficulty, uint64_t seed, ParkingRng& rng) {
+    seedLevelRng(rng, seed, 0);
+    generateParking(p, difficulty, rng);
+}
+
+// Функция рабочего потока
+static void genWorker(GenJob* job) {
+    Parking parking;
+    ParkingRng rng;
+    std::vector<uint8_t> buf;
+
+    for (;;) {
+        uint64_t chunk;
+        {
+            std::unique_lock<std::mutex> lock(job->mutex);
+            if (job->nextChunk >= job->chunkCount) return;
+            chunk = job->nextChunk++;
+            job->freeCv.wait(lock, [&] { return chunk < job->written + job->window; });
+        }
+
+        uint64_t begin = chunk * CHUNK_LEVELS;
+        uint64_t end = begin + CHUNK_LEVELS < job->count ? begin + CHUNK_LEVELS : job->count;
+        buf.resize((end - begin) * MAX_LEVEL_RECORD_BYTES);
+        size_t used = 0;
+        for (uint64_t i = begin; i < end; i++) {
+            generateLevel(parking, job->difficulty, job->firstSeed + i, rng);
+            used += encodeLevel(parking, buf.data() + used);
+        }
+        buf.resize(used);
+
+        std::lock_guard<std::mutex> lock(job->mutex);
+        Chunk& slot = job->slots[chunk % job->window];
+        slot.bytes.swap(buf);
+        slot.ready = true;
+        job->readyCv.notify_all();
+    }
+}
+
+// Функция генерации count уровней; out == NULL - без записи (для замера скорости)
+static bool runGeneration(FILE* out, int difficulty, uint64_t firstSeed, uint64_t count, int threads,
+                          uint64_t* totalBytes, double* seconds) {
+    GenJob job;
+    job.difficulty = difficulty;
+    job.firstSeed = firstSeed;
+    job.count = count;
+    job.chunkCount = (count + CHUNK_LEVELS - 1) / CHUNK_LEVELS;
+    job.window = threads * 4;
+    job.slots.resize(job.window);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++) workers.emplace_back(genWorker, &job);
+
+    // Запись порций в порядке зерен
+    bool ok = true;
+    uint64_t bytes = 0;
+    std::vector<uint8_t> data;
+    for (uint64_t c = 0; c < job.chunkCount; c++) {
+        {
+            std::unique_lock<std::mutex> lock(job.mutex);
+            Chunk& slot = job.slots[c % job.window];
+            job.readyCv.wait(lock, [&] { return slot.ready; });
+            data.swap(slot.bytes);
+            slot.ready = false;
+            job.written++;
+            job.freeCv.notify_all();
+        }
+        if (out && fwrite(data.data(), 1, data.size(), out) != data.size()) ok = false;
+        bytes += data.size();
+    }
+
+    for (std::thread& t : workers) t.join();
+    *seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    *totalBytes = bytes;
+    return ok;
+}
+
+// Функция проверки файла: каждый уровень совпадает с повторной генерацией по его зерну
+static int verifyPack(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("Не удалось открыть %s\n", path);
+        return 1;
+    }
+    LevelPackHeader h;
+    if (!readLevelPackHeader(f, h)) {
+        printf("%s: неверный заголовок\n", path);
+        fclose(f);
+        return 1;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    static Parking loaded, expected;
+    ParkingRng rng;
+    uint8_t record[MAX_LEVEL_RECORD_BYTES];
+    size_t pos = 0;
+    uint64_t mismatches = 0;
+    for (uint64_t i = 0; i < h.levelCount; i++) {
+        size_t used = decodeLevel(data.data() + pos, data.size() - pos, loaded);
+        if (!used) {
+            printf("%s: уровень %llu поврежден\n", path, (unsigned long long)i);
+            return 1;
+        }
+        generateLevel(expected, h.difficulty, h.firstSeed + i, rng);
+        size_t len = encodeLevel(expected, record);
+        if (len != used || memcmp(record, data.data() + pos, len) != 0 ||
+            loaded.carMask != expected.carMask || loaded.obstacleMask != expected.obstacleMask) mismatches++;
+        pos += used;
+    }
+    if (pos != data.size()) {
+        printf("%s: лишние %zu байт в конце файла\n", path, data.size() - pos);
+        return 1;
+    }
+
+    printf("%s: %llu levels, difficulty %d, seeds %llu..%llu, mismatches %llu\n", path,
+           (unsigned long long)h.levelCount, h.difficulty, (unsigned long long)h.firstSeed,
+           (unsigned long long)(h.firstSeed + h.levelCount - 1), (unsigned long long)mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Функция замера масштабирования по числу потоков (1, 2, 4, ... и все ядра)
+static int runScaling(int difficulty, uint64_t count, int maxThreads) {
+    std::vector<int> steps;
+    for (int t = 1; t < maxThreads; t *= 2) steps.push_back(t);
+    steps.push_back(maxThreads);
+
+    double base = 0;
+    for (int t : steps) {
+        uint64_t bytes;
+        double seconds;
+        runGeneration(NULL, difficulty, 0, count, t, &bytes, &seconds);
+        double rate = count / seconds;
+        if (t == 1) base = rate;
+        printf("threads %2d: %10.0f levels/s, speedup %.2f, efficiency %.0f%%\n",
+               t, rate, rate / base, 100 * rate / base / t);
+    }
+    return 0;
+}
+
+static void printUsage() {
+    printf("usage: parking_gen -o FILE [-d 1..3] [-s FIRST_SEED] [-n COUNT] [-t THREADS]\n"
+           "       parking_gen --verify FILE\n"
+           "       parking_gen --scaling [-d 1..3] [-n COUNT] [-t MAX_THREADS]\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* outPath = NULL;
+    const char* verifyPath = NULL;
+    bool scaling = false;
+    int difficulty = 1;
+    uint64_t firstSeed = 0, count = 1000000;
+    int threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "-o") && hasValue) outPath = argv[++i];
+        else if (!strcmp(argv[i], "-d") && hasValue) difficulty = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && hasValue) firstSeed = strtoull(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-n") && hasValue) count = strtoull(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-t") && hasValue) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--verify") && hasValue) verifyPath = argv[++i];
+        else if (!strcmp(argv[i], "--scaling")) scaling = true;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (difficulty < 1 || difficulty > 3 || threads < 1) {
+        printUsage();
+        return 1;
+    }
+    if (verifyPath) return verifyPack(verifyPath);
+    if (scaling) return runScaling(difficulty, count, threads);
+    if (!outPath) {
+        printUsage();
+        return 1;
+    }
+
+    FILE* out = fopen(outPath, "wb");
+    if (!out) {
+        printf("Не удалось создать %s\n", outPath);
+        return 1;
+    }
+
+    LevelPackHeader header;
+    header.difficulty = difficulty;
+    header.firstSeed = firstSeed;
+    header.levelCount = count;
+
+    uint64_t bytes = 0;
+    double seconds = 0;
+    bool ok = writeLevelPackHeader(out, header) &&
+              runGeneration(out, difficulty, firstSeed, count, threads, &bytes, &seconds);
+    if (fclose(out) != 0) ok = false;
+    if (!ok) {
+        printf("Ошибка записи в %s\n", outPath);
+        return 1;
+    }
+
+    printf("%llu levels (difficulty %d, seeds %llu..%llu) on %d threads: %.3f s, %.0f levels/s, %.1f bytes/level\n",
+           (unsigned long long)count, difficulty, (unsigned long long)firstSeed,
+           (unsigned long long)(firstSeed + count - 1), threads, seconds, count / seconds,
+           count ? (double)bytes / count : 0.0);
+    return 0;
+}
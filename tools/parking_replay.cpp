@@ -0,0 +1,283 @@
+// Проверка записанных партий повторной симуляцией
+//
+//   parking_replay FILE                    проверка всех партий файла (итог и число ходов)
+//   parking_replay --random FILE [-n число_партий] [-m ходов] [-d сложность] [-s первое_зерно]
+//                                [-u процент_отмен]
+//                                          дописывание случайных партий (для замера скорости);
+//                                          -u: доля шагов, которые отменяют или повторяют ход
+//   parking_replay --self-check FILE       проверка восстановления файла, оборванного на каждом байте
+//                                          последней партии (FILE - временный, удаляется)
+#include "parking.h"
+#include "level_generator.h"
+#include "replay.h"
+#include "move_journal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+// Функция проверки файла партий
+static int verifyReplays(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("Не удалось открыть %s\n", path);
+        return 1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long bytes = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    ReplayReader reader(f);
+    Replay r;
+    uint64_t replays = 0, moves = 0, won = 0, unfinished = 0, mismatches = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (reader.next(r)) {
+        ReplayOutcome o = simulateReplay(r);
+        if (!replayMatches(r, o)) {
+            if (mismatches < 10)
+                printf("партия %llu (зерно %llu, кандидат %u): записано %s за %d ходов, симуляция - %s за %d%s\n",
+                       (unsigned long long)replays, (unsigned long long)r.header.seed, r.header.attempt,
+                       r.result == REPLAY_WON ? "победа" : "брошена", r.recordedMoves,
+                       o.won ? "победа" : "не победа", o.moves, o.valid ? "" : " (уровень или ходы неверны)");
+            mismatches++;
+        }
+        replays++;
+        moves += r.moves.size();
+        won += r.result == REPLAY_WON;
+        unfinished += r.result == REPLAY_UNFINISHED;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool corrupted = reader.failed();
+    fclose(f);
+
+    if (corrupted) printf("%s: поврежденные данные после партии %llu\n", path, (unsigned long long)replays);
+    printf("%s: %llu replays (%llu won, %llu unfinished), %llu moves, %.2f bytes/move, mismatches %llu\n", path,
+           (unsigned long long)replays, (unsigned long long)won, (unsigned long long)unfinished,
+           (unsigned long long)moves, moves ? (double)bytes / moves : 0.0, (unsigned long long)mismatches);
+    printf("re-simulated in %.3f s: %.2f M moves/s, %.0f replays/s\n", seconds,
+           seconds > 0 ? moves / seconds / 1e6 : 0.0, seconds > 0 ? replays / seconds : 0.0);
+    return corrupted || mismatches ? 1 : 0;
+}
+
+// Функция записи случайных партий: случайные действия над случайными машинами
+static int writeRandomReplays(const char* path, int count, int movesPerReplay, int difficulty, uint64_t firstSeed,
+                              int undoPercent) {
+    ReplayWriter writer;
+    if (!writer.open(path)) {
+        printf("Не удалось открыть %s на запись\n", path);
+        return 1;
+    }
+
+    static Parking p;
+    MoveJournal journal;
+    ParkingRng levelRng, playerRng(firstSeed, 1);
+    for (int i = 0; i < count; i++) {
+        ReplayHeader h;
+        h.difficulty = difficulty;
+        h.seed = firstSeed + i;
+        seedLevelRng(levelRng, h.seed, h.attempt);
+        generateParking(p, difficulty, levelRng);
+
+        writer.begin(h);
+        journal.clear();
+        for (int m = 0; m < movesPerReplay && !checkWin(p); m++) {
+            // Отмена и повтор поровну: повторять есть что только после отмен
+            if (randomInt(playerRng, 100) < undoPercent) {
+                if (randomInt(playerRng, 2) == 0 && journal.canUndo()) {
+                    JournalEntry e = journal.undo();
+                    writer.undo();
+                    undoCarAction(p, &p.cars[e.car], e.action);
+                } else if (journal.canRedo()) {
+                    JournalEntry e = journal.redo();
+                    writer.redo();
+                    applyCarAction(p, &p.cars[e.car], e.action);
+                }
+                continue;
+            }
+            int car = randomInt(playerRng, p.carCount);
+            CarAction action = (CarAction)randomInt(playerRng, 4);
+            writer.move(car, action);
+            if (applyCarAction(p, &p.cars[car], action)) journal.record(car, action);
+        }
+        writer.end(checkWin(p) ? REPLAY_WON : REPLAY_ABANDONED, p.moves);
+    }
+    writer.close();
+    printf("%s: appended %d replays of up to %d moves (difficulty %d, seeds %llu..%llu)\n", path, count,
+           movesPerReplay, difficulty, (unsigned long long)firstSeed, (unsigned long long)(firstSeed + count - 1));
+    return 0;
+}
+
+// Функция чтения всех партий файла (false - поврежденные данные)
+static bool readAll(const char* path, std::vector<Replay>& out) {
+    out.clear();
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    ReplayReader reader(f);
+    Replay r;
+    while (reader.next(r)) out.push_back(r);
+    bool ok = !reader.failed() && !reader.partialHeader();
+    fclose(f);
+    return ok;
+}
+
+static bool sameMoves(const std::vector<ReplayMove>& a, const ReplayMove* b, size_t count) {
+    if (a.size() != count) return false;
+    for (size_t i = 0; i < count; i++)
+        if (a[i].car != b[i].car || a[i].action != b[i].action) return false;
+    return true;
+}
+
+// Функция проверки восстановления после падения: файл обрывается на каждом байте последней партии
+// (в заголовке, посреди многобайтового хода, в конце партии), открывается на дозапись, и за ним
+// пишется еще одна партия. Оборванная в заголовке партия должна исчезнуть, остальные - сохранить
+// только целые ходы и итог "не завершена"; первая и дописанная партии читаются без изменений.
+static int selfCheck(const char* path) {
+    // Номера машин больше 30 дают ходы в несколько байт (как на больших стоянках LotBase)
+    static const ReplayMove first[] = {{3, MOVE_FORWARD}, {40, MOVE_BACKWARD}, {1000, TURN_LEFT}};
+    static const ReplayMove cut[] = {{7, TURN_RIGHT}, {300, MOVE_FORWARD}, {REPLAY_UNDO, MOVE_FORWARD},
+                                     {20000, MOVE_BACKWARD}, {2, TURN_LEFT}};
+    static const ReplayMove last[] = {{9, MOVE_FORWARD}, {500, TURN_RIGHT}};
+    const size_t firstCount = sizeof(first) / sizeof(first[0]), cutCount = sizeof(cut) / sizeof(cut[0]),
+                 lastCount = sizeof(last) / sizeof(last[0]);
+
+    ReplayHeader h;
+    h.board = REPLAY_LOT;
+    h.width = h.height = 64;
+    auto writeMoves = [](ReplayWriter& w, const ReplayMove* moves, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            if (moves[i].car == REPLAY_UNDO) w.undo();
+            else w.move(moves[i].car, moves[i].action);
+        }
+    };
+
+    // Образец: целая первая партия и целая вторая, которую будем обрывать
+    remove(path);
+    ReplayWriter writer;
+    if (!writer.open(path)) {
+        printf("Не удалось открыть %s на запись\n", path);
+        return 1;
+    }
+    h.seed = 1;
+    writer.begin(h);
+    writeMoves(writer, first, firstCount);
+    writer.end(REPLAY_WON, 3);
+    writer.close();
+    FILE* f = fopen(path, "rb");
+    fseek(f, 0, SEEK_END);
+    long secondStart = ftell(f);
+    fclose(f);
+    writer.open(path);
+    h.seed = 2;
+    writer.begin(h);
+    writeMoves(writer, cut, cutCount);
+    writer.end(REPLAY_ABANDONED, 4);
+    writer.close();
+
+    std::vector<uint8_t> bytes;
+    f = fopen(path, "rb");
+    int c;
+    while ((c = fgetc(f)) != EOF) bytes.push_back((uint8_t)c);
+    fclose(f);
+
+    // Конец каждого целого хода второй партии
+    std::vector<size_t> moveEnd;
+    size_t at = secondStart + REPLAY_HEADER_BYTES;
+    for (size_t i = 0; i < cutCount; i++) {
+        uint8_t code[5];
+        at += cut[i].car == REPLAY_UNDO ? 1 : encodeReplayMove(cut[i].car, cut[i].action, code);
+        moveEnd.push_back(at);
+    }
+
+    int failures = 0, headerCuts = 0, midMoveCuts = 0;
+    std::vector<Replay> replays;
+    for (size_t len = secondStart; len < bytes.size(); len++) {
+        f = fopen(path, "wb");
+        fwrite(bytes.data(), 1, len, f);
+        fclose(f);
+
+        // Восстановление и новая партия за оборванной
+        writer.open(path);
+        h.seed = 3;
+        writer.begin(h);
+        writeMoves(writer, last, lastCount);
+        writer.end(REPLAY_WON, 2);
+        writer.close();
+
+        bool inHeader = len < secondStart + REPLAY_HEADER_BYTES;
+        size_t whole = 0;
+        while (whole < cutCount && moveEnd[whole] <= len) whole++;
+        bool midMove = !inHeader && whole < cutCount && len > (whole ? moveEnd[whole - 1] : secondStart + REPLAY_HEADER_BYTES);
+        headerCuts += inHeader;
+        midMoveCuts += midMove;
+
+        bool ok = readAll(path, replays) && replays.size() == (inHeader ? 2u : 3u);
+        ok = ok && replays[0].header.seed == 1 && replays[0].result == REPLAY_WON &&
+             sameMoves(replays[0].moves, first, firstCount);
+        if (ok && !inHeader) {
+            const Replay& r = replays[1];
+            // Ходы целиком до обрыва; после всех ходов обрыв только в конце партии
+            ok = r.header.seed == 2 && r.result == REPLAY_UNFINISHED && sameMoves(r.moves, cut, whole);
+        }
+        if (ok) {
+            const Replay& r = replays.back();
+            ok = r.header.seed == 3 && r.result == REPLAY_WON && r.recordedMoves == 2 &&
+                 sameMoves(r.moves, last, lastCount);
+        }
+        if (!ok) {
+            if (failures < 10) printf("обрыв на байте %zu: файл восстановлен неверно\n", len);
+            failures++;
+        }
+    }
+    remove(path);
+
+    printf("self-check: %zu cut positions (%d in header, %d mid-move), failures %d\n",
+           bytes.size() - secondStart, headerCuts, midMoveCuts, failures);
+    return failures ? 1 : 0;
+}
+
+static void printUsage() {
+    printf("usage: parking_replay FILE\n"
+           "       parking_replay --random FILE [-n REPLAYS] [-m MOVES] [-d 1..3] [-s FIRST_SEED] [-u 0..100]\n"
+           "       parking_replay --self-check FILE\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = NULL;
+    bool random = false, check = false;
+    int count = 1000, movesPerReplay = 1000, difficulty = 1, undoPercent = 0;
+    uint64_t firstSeed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--random") && hasValue) {
+            random = true;
+            path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--self-check") && hasValue) {
+            check = true;
+            path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-n") && hasValue) count = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-m") && hasValue) movesPerReplay = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-d") && hasValue) difficulty = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-u") && hasValue) undoPercent = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && hasValue) firstSeed = strtoull(argv[++i], NULL, 10);
+        else if (argv[i][0] != '-' && !path) path = argv[i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!path || difficulty < 1 || difficulty > 3 || count < 0 || movesPerReplay < 0 ||
+        undoPercent < 0 || undoPercent > 100) {
+        printUsage();
+        return 1;
+    }
+    if (check) return selfCheck(path);
+    if (random) return writeRandomReplays(path, count, movesPerReplay, difficulty, firstSeed, undoPercent);
+    return verifyReplays(path);
+}
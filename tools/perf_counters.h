@@ -0,0 +1,136 @@
+#pragma once
+// Счетчики процессора для бенчмарка через perf_event_open (Linux): такты, инструкции, промахи
+// L1d и последнего уровня кэша, время задачи. Считается только пользовательский код этого процесса
+// (и потоков, созданных после открытия счетчиков). Счетчик, который открыть не удалось (нет прав,
+// виртуальная машина без PMU, не Linux), пропускается, остальные работают. Если не открылся ни
+// один, остается только оценка по времени на часах (source() == PERF_SOURCE_WALL_CLOCK).
+
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_CACHE_MISSES,   // Промахи последнего уровня кэша
+    PERF_TASK_CLOCK,     // Программный счетчик, нс
+    PERF_EVENT_COUNT
+};
+
+// Откуда взяты значения замера
+enum PerfSource {
+    PERF_SOURCE_PMU,         // Аппаратные счетчики процессора (и task-clock)
+    PERF_SOURCE_SOFTWARE,    // Только программный task-clock: время процессора, без тактов и промахов
+    PERF_SOURCE_WALL_CLOCK   // perf_event_open недоступен: время на часах, оценка вместо счетчиков
+};
+
+class PerfCounters {
+public:
+    PerfCounters() {
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            fd_[e] = open((PerfEvent)e);
+            values_[e] = 0;
+        }
+    }
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fd_)
+            if (fd >= 0) close(fd);
+#endif
+    }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Замер копится между start() и stop(), пока не вызван clear()
+    void clear() {
+        for (uint64_t& v : values_) v = 0;
+        wallNs_ = 0;
+    }
+
+    void start() {
+        startTime_ = std::chrono::steady_clock::now();
+#ifdef __linux__
+        for (int fd : fd_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Остановка и чтение; при разделении счетчиков по времени значения пересчитываются на весь отрезок
+    void stop() {
+#ifdef __linux__
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            if (fd_[e] < 0) continue;
+            ioctl(fd_[e], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t r[3] = {0, 0, 0}; // Значение, время включения, время счета
+            if (read(fd_[e], r, sizeof(r)) != (ssize_t)sizeof(r)) continue;
+            values_[e] += r[2] > 0 && r[2] < r[1] ? (uint64_t)((double)r[0] * r[1] / r[2]) : r[0];
+        }
+#endif
+        wallNs_ += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - startTime_).count();
+    }
+
+    bool available(PerfEvent e) const { return fd_[e] >= 0; }
+    uint64_t value(PerfEvent e) const { return values_[e]; }
+    // Есть ли хоть один аппаратный счетчик
+    bool hardware() const {
+        return available(PERF_CYCLES) || available(PERF_INSTRUCTIONS) || available(PERF_L1D_MISSES) ||
+               available(PERF_CACHE_MISSES);
+    }
+    PerfSource source() const {
+        if (hardware()) return PERF_SOURCE_PMU;
+        return available(PERF_TASK_CLOCK) ? PERF_SOURCE_SOFTWARE : PERF_SOURCE_WALL_CLOCK;
+    }
+    // Время на часах между start() и stop(), нс (есть всегда)
+    uint64_t wallNs() const { return wallNs_; }
+
+private:
+    static int open(PerfEvent e) {
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (e) {
+            case PERF_CYCLES:       attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+            case PERF_INSTRUCTIONS: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+            case PERF_CACHE_MISSES: attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+            case PERF_L1D_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case PERF_TASK_CLOCK:
+                attr.type = PERF_TYPE_SOFTWARE;
+                attr.config = PERF_COUNT_SW_TASK_CLOCK;
+                break;
+            default: return -1;
+        }
+        attr.disabled = 1;
+        attr.inherit = 1;        // Потоки пула генератора уровней
+        attr.exclude_kernel = 1; // Достаточно perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+        (void)e;
+        return -1;
+#endif
+    }
+
+    int fd_[PERF_EVENT_COUNT];
+    uint64_t values_[PERF_EVENT_COUNT];
+    uint64_t wallNs_ = 0;
+    std::chrono::steady_clock::time_point startTime_;
+};